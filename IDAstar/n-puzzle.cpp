@@ -4,14 +4,83 @@
 #include <stack>
 #include <chrono>
 #include <list>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
+#include <vector>
+#include <array>
+#include <type_traits>
+#include <string>
+#include <bitset>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 enum Move { up, down, right, left, none };
-int sizeOfBoard;
-std::pair<int, int> emptyTileTargetPos;
 const char numberOfNeightbours = 4;
-std::pair<int, int>* targetPos;
-std::stack<Move> history;
-long long emptyTileNumber;
+int numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+//additive disjoint pattern databases - every group of tiles gets a table with the number of moves of its own tiles
+//needed to bring them to their target positions, the blank and the tiles of the other groups move for free,
+//so the values of the groups can be summed up. The moves of a tile change its manhattan distance by exactly one,
+//so the value and the manhattan distance of the group have the same parity and only (value - manhattan) / 2 is stored
+//in 4 bits (clamped, which keeps it admissible)
+struct PatternDatabase {
+	std::vector<int> tiles;
+	unsigned long long size;
+	const unsigned char* entries;
+	void* mapping;
+	size_t mappingSize;
+};
+
+//the boards around the goal with their distances, see the perimeter search
+struct Perimeter {
+	int depth; //0 - off
+	unsigned long long mask; //number of slots - 1
+	const unsigned long long* entries;
+	std::vector<unsigned long long> storage; //the entries when they are not mapped from a file
+	void* mapping;
+	size_t mappingSize;
+};
+
+//everything that depends only on the size of the board and the goal - built once before the search and then only
+//read, so any number of solvers can share it
+struct Puzzle {
+	int sizeOfBoard;
+	int numberOfCells;
+	std::pair<int, int> emptyTileTargetPos;
+	std::vector<std::pair<int, int>> targetPos;
+
+	//cell = row * sizeOfBoard + col. neightbourCells[cell * numberOfNeightbours + move] is where the blank goes with the move
+	//(-1 outside of the board), manhattanDelta[(tile * numberOfCells + from) * numberOfNeightbours + move] is the change of
+	//the manhattan distance when the tile goes from the cell into the blank - the target cell is given by the move of the blank
+	std::vector<int> neightbourCells;
+	std::vector<int> manhattanDelta;
+	std::vector<unsigned long long> zobristKeys; //random key of tile * numberOfCells + cell for hashing the boards that do not fit in a word
+
+	bool useLinearConflict;
+	std::vector<int> lineConflicts;
+	std::vector<int> linePowers; //(sizeOfBoard + 1) ^ index of the cell inside the line
+
+	bool usePatternDatabase;
+	std::vector<PatternDatabase> patternDatabases;
+	std::vector<int> tileGroup; //tile number -> index of its pattern database, -1 if it is covered only by manhattan
+
+	Perimeter perimeter;
+
+	const Puzzle* reducedPuzzle; //the 3x3 that is left after the reduction of a large board, nullptr if it is searched whole
+};
 
 inline Move getOppositeMove(const Move move) {
 	switch (move) {
@@ -23,7 +92,17 @@ inline Move getOppositeMove(const Move move) {
 	}
 }
 
-const std::pair<int, int> getTargetPos(const int tileIndex) {
+inline const char* getMoveName(const Move move) {
+	switch (move) {
+	case up: return "up";
+	case down: return "down";
+	case right: return "right";
+	case left: return "left";
+	default: return "";
+	}
+}
+
+const std::pair<int, int> getTargetPos(const int sizeOfBoard, const int tileIndex) {
 	if (tileIndex == -2) {
 		return std::pair<int, int>(sizeOfBoard - 1, sizeOfBoard - 1);
 	}
@@ -34,12 +113,13 @@ const std::pair<int, int> getTargetPos(const int tileIndex) {
 }
 
 
-void setUpTargetPosTable(const std::pair<int, int>& emptyTilePos) {
-	targetPos = new std::pair<int, int>[sizeOfBoard * sizeOfBoard];
-	int emptyTileNumber = emptyTileTargetPos.first * sizeOfBoard + emptyTileTargetPos.second + 1;
+void setUpTargetPosTable(Puzzle& puzzle) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	puzzle.targetPos.assign(sizeOfBoard * sizeOfBoard, std::pair<int, int>(0, 0));
+	int emptyTileNumber = puzzle.emptyTileTargetPos.first * sizeOfBoard + puzzle.emptyTileTargetPos.second + 1;
 	for (int i = 1; i < sizeOfBoard * sizeOfBoard; i++) {
 		int offset = i < emptyTileNumber ? -1 : 0;
-		targetPos[i] = getTargetPos(i + offset);
+		puzzle.targetPos[i] = getTargetPos(sizeOfBoard, i + offset);
 	}
 }
 
@@ -54,191 +134,2987 @@ inline const std::pair<const int, const int> nextTile(const std::pair<const int,
 	return next;
 }
 
-const std::pair<int, int> getEmptyTilePos(int** board) {
-	for (int i = 0; i < sizeOfBoard; i++) {
-		for (int j = 0; j < sizeOfBoard; j++) {
-			if (board[i][j] == 0) {
-				return std::pair<int, int>(i, j);
+//linear conflict - two tiles in their target row (column) in reversed order, one of them has to leave the line
+//and come back, which costs two moves over the manhattan distance. A line is encoded as a number in base
+//sizeOfBoard + 1 - the digit of a cell is 0 when its tile does not belong to the line, otherwise 1 + the target
+//index of the tile inside the line. The table gives the minimal number of tiles to take out of the line
+bool useLinearConflict = false;
+
+const int maxLinearConflictSize = 7;
+
+void setUpLinearConflictTable(Puzzle& puzzle) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	const int base = sizeOfBoard + 1;
+	std::vector<int>& linePowers = puzzle.linePowers;
+	linePowers.resize(sizeOfBoard + 1);
+	linePowers[0] = 1;
+	for (int i = 1; i <= sizeOfBoard; i++) {
+		linePowers[i] = linePowers[i - 1] * base;
+	}
+
+	puzzle.lineConflicts.resize(linePowers[sizeOfBoard]);
+	std::vector<int> digits;
+	std::vector<int> longest(sizeOfBoard);
+	for (int key = 0; key < linePowers[sizeOfBoard]; key++) {
+		digits.clear();
+		for (int i = 0; i < sizeOfBoard; i++) {
+			const int digit = key / linePowers[i] % base;
+			if (digit != 0) {
+				digits.push_back(digit);
 			}
 		}
+
+		//the tiles that stay form the longest increasing subsequence
+		int best = 0;
+		for (size_t i = 0; i < digits.size(); i++) {
+			longest[i] = 1;
+			for (size_t j = 0; j < i; j++) {
+				if (digits[j] < digits[i]) {
+					longest[i] = std::max(longest[i], longest[j] + 1);
+				}
+			}
+			best = std::max(best, longest[i]);
+		}
+		puzzle.lineConflicts[key] = digits.size() - best;
 	}
-	return std::pair<int, int>(-1, -1);
 }
 
-inline int updateManhattan(int** board, const std::pair<int, int>& emptyTileCurrentPos, const std::pair<int, int>& emptyTilePreviousPos, const int parentManhattan) {
-	if (emptyTileCurrentPos == emptyTilePreviousPos) {
-		return parentManhattan;
+inline int getRowDigit(const Puzzle& puzzle, const int tile, const int row) {
+	return tile != 0 && puzzle.targetPos[tile].first == row ? puzzle.targetPos[tile].second + 1 : 0;
+}
+
+inline int getColDigit(const Puzzle& puzzle, const int tile, const int col) {
+	return tile != 0 && puzzle.targetPos[tile].second == col ? puzzle.targetPos[tile].first + 1 : 0;
+}
+
+template <class Board>
+inline int getRowKey(const Puzzle& puzzle, const Board& board, const int row) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	int key = 0;
+	for (int i = sizeOfBoard - 1; i >= 0; i--) {
+		key = key * (sizeOfBoard + 1) + getRowDigit(puzzle, board.tileAt(row * sizeOfBoard + i), row);
 	}
-	const int number = board[emptyTilePreviousPos.first][emptyTilePreviousPos.second];
-	const std::pair<int, int>& target = targetPos[number];
-	return parentManhattan - (abs(emptyTileCurrentPos.first - target.first) + abs(emptyTileCurrentPos.second - target.second)) +
-		abs(emptyTilePreviousPos.first - target.first) + abs(emptyTilePreviousPos.second - target.second);
+	return key;
 }
 
-int calculateManhattan(int** board) {
-	int distance = 0;
-	for (int i = 0; i < sizeOfBoard; i++) {
-		for (int j = 0; j < sizeOfBoard; j++) {
-			if (board[i][j] == 0) continue;
-			const std::pair<int, int>& target = targetPos[board[i][j]];
-			distance += abs(i - target.first) + abs(j - target.second);
-		}
+template <class Board>
+inline int getColKey(const Puzzle& puzzle, const Board& board, const int col) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	int key = 0;
+	for (int i = sizeOfBoard - 1; i >= 0; i--) {
+		key = key * (sizeOfBoard + 1) + getColDigit(puzzle, board.tileAt(i * sizeOfBoard + col), col);
 	}
-	return distance;
+	return key;
 }
 
-long long countInversions(int** board) {
-	long long inversions = 0;
-	int temp = 0;
-	int* brd = new int[sizeOfBoard * sizeOfBoard];
-	for (int i = 0; i < sizeOfBoard; i++) {
-		for (int j = 0; j < sizeOfBoard; j++) {
-			brd[temp] = board[i][j];
-			temp++;
-		}
+template <class Board>
+int calculateLinearConflict(const Puzzle& puzzle, const Board& board) {
+	int conflicts = 0;
+	for (int i = 0; i < puzzle.sizeOfBoard; i++) {
+		conflicts += puzzle.lineConflicts[getRowKey(puzzle, board, i)] + puzzle.lineConflicts[getColKey(puzzle, board, i)];
 	}
+	return 2 * conflicts;
+}
 
-	for (int i = 0; i < sizeOfBoard * sizeOfBoard; i++) {
-		for (int j = i + 1; j < sizeOfBoard * sizeOfBoard; j++) {
-			if (brd[j] < brd[i] && brd[i] != 0 && brd[j] != 0) {
-				inversions++;
-			}
+//change of the linear conflict when the tile goes from the cell into the blank, only the lines the tile leaves
+//and enters can change - the blank does not count, so the order inside the line it moves along stays the same
+template <class Board>
+inline int getLinearConflictDelta(const Puzzle& puzzle, const Board& board, const int tile, const int from, const int to) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	const int* lineConflicts = puzzle.lineConflicts.data();
+	const int* linePowers = puzzle.linePowers.data();
+	const int fromRow = from / sizeOfBoard;
+	const int fromCol = from % sizeOfBoard;
+	const int toRow = to / sizeOfBoard;
+	const int toCol = to % sizeOfBoard;
+
+	int delta = 0;
+	if (fromCol == toCol) {
+		const int leftDigit = getRowDigit(puzzle, tile, fromRow);
+		if (leftDigit != 0) {
+			const int key = getRowKey(puzzle, board, fromRow);
+			delta += lineConflicts[key - leftDigit * linePowers[fromCol]] - lineConflicts[key];
+		}
+		const int enteredDigit = getRowDigit(puzzle, tile, toRow);
+		if (enteredDigit != 0) {
+			const int key = getRowKey(puzzle, board, toRow);
+			delta += lineConflicts[key + enteredDigit * linePowers[toCol]] - lineConflicts[key];
 		}
 	}
+	else {
+		const int leftDigit = getColDigit(puzzle, tile, fromCol);
+		if (leftDigit != 0) {
+			const int key = getColKey(puzzle, board, fromCol);
+			delta += lineConflicts[key - leftDigit * linePowers[fromRow]] - lineConflicts[key];
+		}
+		const int enteredDigit = getColDigit(puzzle, tile, toCol);
+		if (enteredDigit != 0) {
+			const int key = getColKey(puzzle, board, toCol);
+			delta += lineConflicts[key + enteredDigit * linePowers[toRow]] - lineConflicts[key];
+		}
+	}
+	return 2 * delta;
+}
 
-	delete[] brd;
+//binary indexed tree over the tile numbers, O(n log n) so that the check stays cheap on large boards
+long long countInversions(const std::vector<int>& tiles) {
+	std::vector<int> tree(tiles.size() + 1, 0);
+	long long inversions = 0;
+	int seen = 0;
+	for (const int tile : tiles) {
+		if (tile == 0) {
+			continue;
+		}
+		int notGreater = 0;
+		for (int i = tile; i > 0; i -= i & -i) {
+			notGreater += tree[i];
+		}
+		inversions += seen - notGreater;
+		for (int i = tile; i < static_cast<int>(tree.size()); i += i & -i) {
+			tree[i]++;
+		}
+		seen++;
+	}
 	return inversions;
 }
 
-bool isSolvable(int** start) {
+//tiles are the cells of the board row by row
+bool isSolvable(const int sizeOfBoard, const std::pair<int, int>& emptyTileTargetPos, const std::vector<int>& tiles) {
 	int emptyTileRowStart = -1;
-	for (int i = 0; i < sizeOfBoard; i++) {
-		for (int j = 0; j < sizeOfBoard; j++) {
-			if (start[i][j] == 0) {
-				emptyTileRowStart = i;
-			}
+	for (int cell = 0; cell < static_cast<int>(tiles.size()); cell++) {
+		if (tiles[cell] == 0) {
+			emptyTileRowStart = cell / sizeOfBoard;
 		}
 	}
 
-	long long parityStart = countInversions(start) + (sizeOfBoard % 2 == 0 ? emptyTileRowStart : 0);
+	long long parityStart = countInversions(tiles) + (sizeOfBoard % 2 == 0 ? emptyTileRowStart : 0);
 	long long parityEnd = sizeOfBoard % 2 == 0 ? emptyTileTargetPos.first : 0;
 
 	return parityStart % 2 == parityEnd % 2;
 }
 
 
-inline bool isTileValid(const std::pair<int, int>& tilePos) {
+inline bool isTileValid(const int sizeOfBoard, const std::pair<int, int>& tilePos) {
 	return (tilePos.first >= 0 && tilePos.first < sizeOfBoard) &&
 		(tilePos.second >= 0 && tilePos.second < sizeOfBoard);
 }
 
-inline void swapTile(int** board, const std::pair<int, int>& a, const std::pair<int, int>& b) {
-	const int temp = board[a.first][a.second];
-	board[a.first][a.second] = board[b.first][b.second];
-	board[b.first][b.second] = temp;
+inline unsigned long long mixBits(unsigned long long x) {
+	x ^= x >> 30;
+	x *= 0xBF58476D1CE4E5B9ull;
+	x ^= x >> 27;
+	x *= 0x94D049BB133111EBull;
+	return x ^ (x >> 31);
 }
 
-inline int search(int** board, const std::pair<int, int>& emptyTilePos, const int path, const int threshold, const Move prevMove, const int parentManhattan) {
-	const Move oppositePrevMove = getOppositeMove(prevMove);
-	const std::pair<int, int>& prevEmptyTilePos = nextTile(emptyTilePos, oppositePrevMove);
-	const int heuristic = updateManhattan(board, emptyTilePos, prevEmptyTilePos, parentManhattan);
-	const int cost = heuristic + path;
+inline int getTargetDistance(const Puzzle& puzzle, const int tile, const int cell) {
+	return abs(cell / puzzle.sizeOfBoard - puzzle.targetPos[tile].first) + abs(cell % puzzle.sizeOfBoard - puzzle.targetPos[tile].second);
+}
 
-	if (cost > threshold) {
-		return cost;
+void setUpMoveTables(Puzzle& puzzle) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	const int numberOfCells = puzzle.numberOfCells;
+	std::vector<int>& neightbourCells = puzzle.neightbourCells;
+	neightbourCells.resize(numberOfCells * numberOfNeightbours);
+	for (int cell = 0; cell < numberOfCells; cell++) {
+		for (int i = 0; i < numberOfNeightbours; i++) {
+			const std::pair<int, int>& neightbour = nextTile(std::pair<int, int>(cell / sizeOfBoard, cell % sizeOfBoard), static_cast<Move>(i));
+			neightbourCells[cell * numberOfNeightbours + i] = isTileValid(sizeOfBoard, neightbour) ? neightbour.first * sizeOfBoard + neightbour.second : -1;
+		}
 	}
-	else if (heuristic == 0) {
-		history.push(prevMove);
-		std::cout << path << std::endl;
-		return 0;
+
+	puzzle.manhattanDelta.resize(numberOfCells * numberOfCells * numberOfNeightbours);
+	for (int tile = 0; tile < numberOfCells; tile++) {
+		for (int from = 0; from < numberOfCells; from++) {
+			for (int i = 0; i < numberOfNeightbours; i++) {
+				//the blank made move i from the cell it was on to from
+				const int to = neightbourCells[from * numberOfNeightbours + getOppositeMove(static_cast<Move>(i))];
+				puzzle.manhattanDelta[(tile * numberOfCells + from) * numberOfNeightbours + i] = tile == 0 || to == -1 ? 0 :
+					getTargetDistance(puzzle, tile, to) - getTargetDistance(puzzle, tile, from);
+			}
+		}
 	}
 
-	int min = INT32_MAX;
-	for (int i = 0; i < numberOfNeightbours; i++) {
-		if (oppositePrevMove == i) {
-			continue;
+	puzzle.zobristKeys.resize(numberOfCells * numberOfCells);
+	for (int i = 0; i < numberOfCells * numberOfCells; i++) {
+		puzzle.zobristKeys[i] = mixBits(i + 1);
+	}
+}
+
+//the tables of the common widths built at compile time - with the width as a template argument of the board the
+//search reads them at constant offsets instead of going through the size of the board and the tables of the puzzle
+template <int Width>
+struct FixedTables {
+	static constexpr int numberOfCells = Width * Width;
+	int neightbourCells[numberOfCells * numberOfNeightbours];
+	struct DeltaRow {
+		signed char deltas[numberOfCells * numberOfNeightbours]; //(from, move) -> change of the distance of one tile
+	};
+	DeltaRow manhattanDelta[numberOfCells][numberOfCells]; //cell of the blank in the goal -> tile -> its row
+
+	constexpr FixedTables() : neightbourCells(), manhattanDelta() {
+		//up, down, right and left of the blank as in nextTile
+		const int rowStep[numberOfNeightbours] = { 1, -1, 0, 0 };
+		const int colStep[numberOfNeightbours] = { 0, 0, -1, 1 };
+		for (int cell = 0; cell < numberOfCells; cell++) {
+			for (int i = 0; i < numberOfNeightbours; i++) {
+				const int row = cell / Width + rowStep[i];
+				const int col = cell % Width + colStep[i];
+				neightbourCells[cell * numberOfNeightbours + i] = row >= 0 && row < Width && col >= 0 && col < Width ? row * Width + col : -1;
+			}
 		}
 
-		const std::pair<int, int>& neightbour = nextTile(emptyTilePos, static_cast<Move>(i));
-		if (!isTileValid(neightbour)) {
-			continue;
+		//the deltas depend only on the cell the tile is going to, so they are worked out once per cell and the goals
+		//share the rows as whole copies - the table stays well within the default limits of constant evaluation
+		DeltaRow targetDelta[numberOfCells] = {}; //cell in the goal -> its row
+		for (int target = 0; target < numberOfCells; target++) {
+			for (int from = 0; from < numberOfCells; from++) {
+				const int fromDistance = abs(from / Width - target / Width) + abs(from % Width - target % Width);
+				for (int i = 0; i < numberOfNeightbours; i++) {
+					//the blank made move i from the cell it was on to from, the opposite move is i ^ 1
+					const int to = neightbourCells[from * numberOfNeightbours + (i ^ 1)];
+					if (to != -1) {
+						targetDelta[target].deltas[from * numberOfNeightbours + i] = abs(to / Width - target / Width) + abs(to % Width - target % Width) - fromDistance;
+					}
+				}
+			}
+		}
+
+		for (int goal = 0; goal < numberOfCells; goal++) {
+			for (int tile = 1; tile < numberOfCells; tile++) {
+				manhattanDelta[goal][tile] = targetDelta[tile <= goal ? tile - 1 : tile];
+			}
 		}
+	}
+};
+
+template <int Width>
+constexpr FixedTables<Width> fixedTables = FixedTables<Width>();
+
+//what is added to the manhattan distance - a template argument of the board, so the search with the manhattan
+//distance alone does not test for the others on every node
+enum Heuristic { manhattanOnly, withPatternDatabases, withLinearConflict };
+
+//boards up to 4x4 - 4 bits per cell (and per tile for the inverse), the whole state fits in two words and the blank
+template <int Width, Heuristic H = manhattanOnly>
+struct PackedBoard {
+	static constexpr int width = Width;
+	static constexpr bool packed = true;
+	static constexpr Heuristic heuristic = H;
+	unsigned long long tiles; //cell -> tile
+	unsigned long long places; //tile -> cell, kept up to date only for the pattern databases, which look the tiles up
+	int blank;
+
+	void load(const Puzzle& puzzle, const std::vector<int>& board) {
+		tiles = 0;
+		places = 0;
+		for (int cell = 0; cell < puzzle.numberOfCells; cell++) {
+			const unsigned long long tile = board[cell];
+			tiles |= tile << (cell << 2);
+			places |= static_cast<unsigned long long>(cell) << (tile << 2);
+			if (tile == 0) {
+				blank = cell;
+			}
+		}
+	}
+
+	inline int tileAt(const int cell) const {
+		return (tiles >> (cell << 2)) & 0xF;
+	}
+
+	inline int cellOf(const int tile) const {
+		return (places >> (tile << 2)) & 0xF;
+	}
+
+	//moves the tile on the cell into the blank, the blank nibble is always 0, so xor swaps them
+	inline void slide(const int cell) {
+		const unsigned long long tile = tileAt(cell);
+		tiles ^= (tile << (cell << 2)) | (tile << (blank << 2));
+		if constexpr (H == withPatternDatabases) {
+			const unsigned long long change = cell ^ blank;
+			places ^= (change << (tile << 2)) | change;
+		}
+		blank = cell;
+	}
+
+	inline unsigned long long hash() const {
+		return mixBits(tiles);
+	}
+};
+
+//any size - the tiles and their cells in flat arrays, Width 0 - the size is known only at run time
+template <int Width = 0, Heuristic H = manhattanOnly>
+struct GridBoard {
+	static constexpr int width = Width;
+	static constexpr bool packed = false;
+	static constexpr Heuristic heuristic = H;
+	//a fixed width keeps the arrays inside the board, so copying it does not allocate
+	typedef typename std::conditional<Width == 0, std::vector<int>, std::array<int, Width * Width>>::type Cells;
+	Cells tiles; //cell -> tile
+	Cells places; //tile -> cell, kept up to date only for the pattern databases
+	int blank;
+	unsigned long long key; //xor of the zobrist keys of the tiles
+	const unsigned long long* zobristKeys;
+	int numberOfCells;
+
+	void load(const Puzzle& puzzle, const std::vector<int>& board) {
+		numberOfCells = puzzle.numberOfCells;
+		zobristKeys = puzzle.zobristKeys.data();
+		if constexpr (Width == 0) {
+			tiles.resize(numberOfCells);
+			places.resize(numberOfCells);
+		}
+		key = 0;
+		for (int cell = 0; cell < numberOfCells; cell++) {
+			tiles[cell] = board[cell];
+			places[tiles[cell]] = cell;
+			if (tiles[cell] == 0) {
+				blank = cell;
+			}
+			else {
+				key ^= zobristKeys[tiles[cell] * numberOfCells + cell];
+			}
+		}
+	}
 
-		swapTile(board, neightbour, emptyTilePos);
-		const int temp = search(board, neightbour, path + 1, threshold, static_cast<Move>(i), heuristic);
-		swapTile(board, neightbour, emptyTilePos);
+	inline int tileAt(const int cell) const {
+		return tiles[cell];
+	}
+
+	inline int cellOf(const int tile) const {
+		return places[tile];
+	}
 
-		if (temp == 0) {
-			history.push(prevMove);
-			return 0;
+	inline void slide(const int cell) {
+		const int tile = tiles[cell];
+		tiles[blank] = tile;
+		tiles[cell] = 0;
+		if constexpr (H == withPatternDatabases) {
+			places[tile] = blank;
+			places[0] = cell;
 		}
-		else if (temp < min) {
-			min = temp;
+		const int cells = Width == 0 ? numberOfCells : Width * Width;
+		key ^= zobristKeys[tile * cells + cell] ^ zobristKeys[tile * cells + blank];
+		blank = cell;
+	}
+
+	inline unsigned long long hash() const {
+		return mixBits(key);
+	}
+};
+
+template <class Board>
+int calculateManhattan(const Puzzle& puzzle, const Board& board) {
+	int distance = 0;
+	for (int cell = 0; cell < puzzle.numberOfCells; cell++) {
+		const int tile = board.tileAt(cell);
+		if (tile == 0) continue;
+		distance += getTargetDistance(puzzle, tile, cell);
+	}
+	return distance;
+}
+
+struct PatternFileHeader {
+	char magic[4];
+	int sizeOfBoard;
+	int emptyTileCell;
+	int numberOfTiles;
+	int tiles[32];
+};
+
+const char patternFileMagic[4] = { 'P', 'D', 'B', '1' };
+bool usePatternDatabase = false;
+std::vector<int> patternPartition; //sizes of the groups, empty -> default for the size of the board
+std::string patternDirectory = ".";
+
+//the larger groups take minutes and a few gigabytes to build, but only once - see buildPatternDatabase
+const std::vector<int> getDefaultPartition(const int sizeOfBoard) {
+	switch (sizeOfBoard) {
+	case 3: return { 4, 4 };
+	case 4: return { 7, 8 };
+	case 5: return { 6, 6, 6, 6 };
+	default: return {};
+	}
+}
+
+inline int countBits(const unsigned int mask) {
+	return std::bitset<32>(mask).count();
+}
+
+//lexicographic rank of the arrangement of the group's tiles over the cells of the board
+inline unsigned long long rankPositions(const int numberOfCells, const int* positions, const int count) {
+	unsigned long long rank = 0;
+	unsigned int used = 0;
+	for (int i = 0; i < count; i++) {
+		rank = rank * (numberOfCells - i) + positions[i] - countBits(used & ((1u << positions[i]) - 1));
+		used |= 1u << positions[i];
+	}
+	return rank;
+}
+
+void unrankPositions(const int numberOfCells, unsigned long long rank, const int count, int* positions) {
+	int digits[32];
+	for (int i = count - 1; i >= 0; i--) {
+		digits[i] = rank % (numberOfCells - i);
+		rank /= numberOfCells - i;
+	}
+
+	unsigned int used = 0;
+	for (int i = 0; i < count; i++) {
+		int cell = 0;
+		for (int skipped = -1; ; cell++) {
+			if (!(used & (1u << cell)) && ++skipped == digits[i]) {
+				break;
+			}
 		}
+		positions[i] = cell;
+		used |= 1u << cell;
 	}
-	return min;
 }
 
-void IDA(int** startBoard) {
-	const std::pair<const int, const int>& emptyTilePos = getEmptyTilePos(startBoard);
-	const int startHeuristic = calculateManhattan(startBoard);
-	int threshold = startHeuristic;
-	while (true) {
-		//std::cout << "threshold :" << threshold << std::endl;
-		int answer = search(startBoard, emptyTilePos, 0, threshold, none, startHeuristic);
-		if (answer == 0) {
+inline int getPatternEntry(const unsigned char* entries, const unsigned long long rank) {
+	return (entries[rank >> 1] >> ((rank & 1) << 2)) & 0xF;
+}
+
+//movedTile is looked up as if it were on movedTo
+template <class Board>
+inline int lookupPattern(const Puzzle& puzzle, const Board& board, const int group, const int movedTile = -1, const int movedTo = -1) {
+	const PatternDatabase& pdb = puzzle.patternDatabases[group];
+	int positions[32];
+	for (size_t i = 0; i < pdb.tiles.size(); i++) {
+		positions[i] = pdb.tiles[i] == movedTile ? movedTo : board.cellOf(pdb.tiles[i]);
+	}
+	return getPatternEntry(pdb.entries, rankPositions(puzzle.numberOfCells, positions, pdb.tiles.size()));
+}
+
+int patternManhattan(const Puzzle& puzzle, const std::vector<int>& tiles, const int* positions) {
+	int distance = 0;
+	for (size_t i = 0; i < tiles.size(); i++) {
+		distance += getTargetDistance(puzzle, tiles[i], positions[i]);
+	}
+	return distance;
+}
+
+template <typename Function>
+void parallelFor(const size_t count, const Function& function) {
+	const int workers = std::max<size_t>(1, std::min<size_t>(numberOfThreads, count / 1024));
+	std::vector<std::thread> threads;
+	for (int i = 1; i < workers; i++) {
+		threads.emplace_back(function, i, count * i / workers, count * (i + 1) / workers);
+	}
+	function(0, 0, count / workers);
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+inline int getLowestCell(const unsigned int mask) {
+	return countBits((mask & (~mask + 1)) - 1);
+}
+
+//breadth first search from the target arrangement over (arrangement, region of the blank) states - the blank walks
+//around the tiles of the group for free, so a state stands for all cells of its region and is kept under the lowest
+//one, and every move of a tile of the group costs 1. The visited states and the two layers are bitmaps, a bit per
+//arrangement and cell, so 7-8 on 4x4 and 6-6-6-6 on 5x5 fit in memory. The layers are split between the threads by
+//words and the bits are set with atomic operations
+void buildPatternDatabase(const Puzzle& puzzle, const std::vector<int>& tiles, unsigned char* result, const unsigned long long size) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	const int numberOfCells = puzzle.numberOfCells;
+	const int* neightbourCells = puzzle.neightbourCells.data();
+	const int count = tiles.size();
+	const unsigned int allCells = numberOfCells == 32 ? ~0u : (1u << numberOfCells) - 1;
+	unsigned int firstColumn = 0;
+	for (int row = 0; row < sizeOfBoard; row++) {
+		firstColumn |= 1u << (row * sizeOfBoard);
+	}
+	const unsigned int lastColumn = firstColumn << (sizeOfBoard - 1);
+	const size_t numberOfWords = (size * numberOfCells + 63) / 64;
+	std::vector<std::atomic<unsigned long long>> visited(numberOfWords);
+	std::vector<std::atomic<unsigned long long>> layer(numberOfWords);
+	std::vector<std::atomic<unsigned long long>> next(numberOfWords);
+	std::vector<std::atomic<unsigned char>> entries((size + 1) / 2);
+	for (std::atomic<unsigned char>& entry : entries) {
+		entry.store(0xFF, std::memory_order_relaxed);
+	}
+
+	auto markVisited = [&visited](const unsigned long long state) {
+		const unsigned long long bit = 1ull << (state & 63);
+		return !(visited[state >> 6].load(std::memory_order_relaxed) & bit) &&
+			!(visited[state >> 6].fetch_or(bit, std::memory_order_relaxed) & bit);
+	};
+
+	//cells the blank reaches from the cell without moving a tile of the group, free has a bit for every other cell.
+	//The region grows by a step in all directions at once until it stops changing
+	auto getBlankRegion = [=](const unsigned int free, const int cell) {
+		unsigned int region = 1u << cell;
+		while (true) {
+			const unsigned int grown = (region | (region & ~lastColumn) << 1 | (region & ~firstColumn) >> 1 |
+				region << sizeOfBoard | region >> sizeOfBoard) & free;
+			if (grown == region) {
+				return region;
+			}
+			region = grown;
+		}
+	};
+
+	auto setEntry = [&entries](const unsigned long long rank, const int value) {
+		std::atomic<unsigned char>& entry = entries[rank >> 1];
+		const int shift = (rank & 1) << 2;
+		unsigned char current = entry.load(std::memory_order_relaxed);
+		while (((current >> shift) & 0xF) > value &&
+			!entry.compare_exchange_weak(current, (current & ~(0xF << shift)) | (value << shift), std::memory_order_relaxed));
+	};
+
+	//expands the states of the layer in the words [begin, end) into the next layer
+	auto expand = [&](const size_t begin, const size_t end, const int cost) {
+		int positions[32];
+		int cellSlot[32];
+		for (size_t word = begin; word < end; word++) {
+			for (unsigned long long bits = layer[word].load(std::memory_order_relaxed); bits != 0; bits &= bits - 1) {
+				const unsigned long long state = word * 64 + std::bitset<64>((bits & (~bits + 1)) - 1).count();
+				const unsigned long long rank = state / numberOfCells;
+				unrankPositions(numberOfCells, rank, count, positions);
+				setEntry(rank, std::min(15, (cost - patternManhattan(puzzle, tiles, positions)) / 2));
+
+				unsigned int free = allCells;
+				std::fill(cellSlot, cellSlot + numberOfCells, -1);
+				for (int j = 0; j < count; j++) {
+					cellSlot[positions[j]] = j;
+					free &= ~(1u << positions[j]);
+				}
+				const unsigned int region = getBlankRegion(free, state % numberOfCells);
+				for (int blank = 0; blank < numberOfCells; blank++) {
+					if (!(region & (1u << blank))) {
+						continue;
+					}
+					for (int j = 0; j < numberOfNeightbours; j++) {
+						const int cell = neightbourCells[blank * numberOfNeightbours + j];
+						if (cell == -1 || cellSlot[cell] == -1) {
+							continue;
+						}
+
+						//the tile on cell slides to the blank, which takes its place
+						const int slot = cellSlot[cell];
+						positions[slot] = blank;
+						const unsigned long long nextRank = rankPositions(numberOfCells, positions, count);
+						positions[slot] = cell;
+						const unsigned int nextRegion = getBlankRegion((free & ~(1u << blank)) | (1u << cell), cell);
+						const unsigned long long nextState = nextRank * numberOfCells + getLowestCell(nextRegion);
+						if (markVisited(nextState)) {
+							next[nextState >> 6].fetch_or(1ull << (nextState & 63), std::memory_order_relaxed);
+						}
+					}
+				}
+			}
+		}
+	};
+
+	int positions[32];
+	unsigned int free = allCells;
+	for (int i = 0; i < count; i++) {
+		const std::pair<int, int>& target = puzzle.targetPos[tiles[i]];
+		positions[i] = target.first * sizeOfBoard + target.second;
+		free &= ~(1u << positions[i]);
+	}
+	const unsigned int region = getBlankRegion(free, puzzle.emptyTileTargetPos.first * sizeOfBoard + puzzle.emptyTileTargetPos.second);
+	const unsigned long long start = rankPositions(numberOfCells, positions, count) * numberOfCells + getLowestCell(region);
+	markVisited(start);
+	layer[start >> 6].store(1ull << (start & 63), std::memory_order_relaxed);
+
+	for (int cost = 0; ; cost++) {
+		parallelFor(numberOfWords, [&](const int, const size_t begin, const size_t end) {
+			expand(begin, end, cost);
+		});
+
+		std::atomic<bool> reached(false);
+		parallelFor(numberOfWords, [&](const int, const size_t begin, const size_t end) {
+			bool any = false;
+			for (size_t word = begin; word < end; word++) {
+				layer[word].store(0, std::memory_order_relaxed);
+				any = any || next[word].load(std::memory_order_relaxed) != 0;
+			}
+			if (any) {
+				reached.store(true, std::memory_order_relaxed);
+			}
+		});
+		if (!reached.load()) {
 			break;
 		}
-		threshold = answer;
+		layer.swap(next);
+	}
+
+	for (unsigned long long i = 0; i < entries.size(); i++) {
+		result[i] = entries[i].load(std::memory_order_relaxed);
 	}
 }
 
-int main() {
-	int numberOfTiles = -1;
-	std::cin >> numberOfTiles;
-	sizeOfBoard = sqrt(numberOfTiles + 1);
+const std::string getPatternFileName(const Puzzle& puzzle, const std::vector<int>& tiles) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	std::string name = patternDirectory + "/pdb-" + std::to_string(sizeOfBoard) + "x" + std::to_string(sizeOfBoard) +
+		"-e" + std::to_string(puzzle.emptyTileTargetPos.first * sizeOfBoard + puzzle.emptyTileTargetPos.second);
+	for (const int tile : tiles) {
+		name += "-" + std::to_string(tile);
+	}
+	return name + ".bin";
+}
 
-	int emptyTileNumber = -1;
-	std::cin >> emptyTileNumber;
-	emptyTileTargetPos = getTargetPos(emptyTileNumber - 1);
+const PatternFileHeader getPatternFileHeader(const Puzzle& puzzle, const std::vector<int>& tiles) {
+	PatternFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, patternFileMagic, sizeof(header.magic));
+	header.sizeOfBoard = puzzle.sizeOfBoard;
+	header.emptyTileCell = puzzle.emptyTileTargetPos.first * puzzle.sizeOfBoard + puzzle.emptyTileTargetPos.second;
+	header.numberOfTiles = tiles.size();
+	std::copy(tiles.begin(), tiles.end(), header.tiles);
+	return header;
+}
+
+bool mapPatternFile(const Puzzle& puzzle, const std::string& fileName, PatternDatabase& pdb) {
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat info;
+	const size_t expectedSize = sizeof(PatternFileHeader) + (pdb.size + 1) / 2;
+	if (fstat(fd, &info) == -1 || static_cast<size_t>(info.st_size) != expectedSize) {
+		close(fd);
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, expectedSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	const PatternFileHeader header = getPatternFileHeader(puzzle, pdb.tiles);
+	if (std::memcmp(mapping, &header, sizeof(header)) != 0) {
+		munmap(mapping, expectedSize);
+		return false;
+	}
+
+	pdb.mapping = mapping;
+	pdb.mappingSize = expectedSize;
+	pdb.entries = static_cast<const unsigned char*>(mapping) + sizeof(PatternFileHeader);
+	return true;
+}
+
+//loads the tables from the pattern directory, the missing ones are built and saved first
+bool setUpPatternDatabases(Puzzle& puzzle) {
+	const std::vector<int>& partition = patternPartition.empty() ? getDefaultPartition(puzzle.sizeOfBoard) : patternPartition;
+	const int numberOfCells = puzzle.numberOfCells;
+	int coveredTiles = 0;
+	for (const int groupSize : partition) {
+		coveredTiles += groupSize;
+	}
+	if (partition.empty() || coveredTiles >= numberOfCells || numberOfCells > 32) {
+		std::cerr << "No pattern database partition for this board, using manhattan distance." << std::endl;
+		return false;
+	}
+
+	puzzle.tileGroup.assign(numberOfCells, -1);
+	int tile = 1;
+	for (const int groupSize : partition) {
+		PatternDatabase pdb;
+		pdb.size = 1;
+		for (int i = 0; i < groupSize; i++, tile++) {
+			pdb.tiles.push_back(tile);
+			puzzle.tileGroup[tile] = puzzle.patternDatabases.size();
+			pdb.size *= numberOfCells - i;
+		}
+
+		const std::string fileName = getPatternFileName(puzzle, pdb.tiles);
+		if (!mapPatternFile(puzzle, fileName, pdb)) {
+			std::cerr << "Building the pattern database " << fileName << std::endl;
+			std::vector<unsigned char> entries((pdb.size + 1) / 2);
+			buildPatternDatabase(puzzle, pdb.tiles, entries.data(), pdb.size);
+
+			const PatternFileHeader header = getPatternFileHeader(puzzle, pdb.tiles);
+			std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(entries.data()), entries.size());
+			file.close();
 
-	int** board = new int* [sizeOfBoard];
-	for (int i = 0; i < sizeOfBoard; i++) {
-		board[i] = new int[sizeOfBoard];
-		for (int j = 0; j < sizeOfBoard; j++) {
-			std::cin >> board[i][j];
+			if (!file || !mapPatternFile(puzzle, fileName, pdb)) {
+				std::cerr << "Could not save the pattern database " << fileName << std::endl;
+				return false;
+			}
 		}
+		puzzle.patternDatabases.push_back(pdb);
 	}
+	return true;
+}
 
-	if (!isSolvable(board)) {
-		std::cout << "The puzzle is unsolvable." << std::endl;
+void releasePatternDatabases(Puzzle& puzzle) {
+	for (const PatternDatabase& pdb : puzzle.patternDatabases) {
+		munmap(pdb.mapping, pdb.mappingSize);
+	}
+	puzzle.patternDatabases.clear();
+}
+
+template <class Board>
+int calculatePatternDatabases(const Puzzle& puzzle, const Board& board) {
+	int extra = 0;
+	for (size_t i = 0; i < puzzle.patternDatabases.size(); i++) {
+		extra += 2 * lookupPattern(puzzle, board, i);
+	}
+	return extra;
+}
+
+//change of the pattern database part of the heuristic when the tile goes into the blank
+template <class Board>
+inline int getPatternDelta(const Puzzle& puzzle, const Board& board, const int tile, const int to) {
+	const int group = puzzle.tileGroup[tile];
+	if (group == -1) {
 		return 0;
 	}
-	setUpTargetPosTable(emptyTileTargetPos);
+	return 2 * (lookupPattern(puzzle, board, group, tile, to) - lookupPattern(puzzle, board, group));
+}
 
-	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-	IDA(board);
-	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+//perimeter search - every board within perimeterDepth moves of the goal is stored with its distance in an open
+//addressing table. The packed tiles without the last cell (its tile is the one missing from the others) fit in
+//60 bits, the distance takes the upper 4, so an entry is a single word and 0 is an empty slot. A board in the table
+//ends the search with its exact cost, a board with h <= perimeterDepth that is not in it is at least
+//perimeterDepth + 1 moves away. Only the packed boards, their keys are exact
+int perimeterDepth = 0; //0 - off
+bool mapPerimeter = false; //keep the table in the pattern directory and map it on the next start
+const int maxPerimeterDepth = 15;
+const int perimeterShift = 60;
+const unsigned long long perimeterKeyMask = (1ull << perimeterShift) - 1;
 
-	std::cout << "Time consumed :" << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+struct PerimeterFileHeader {
+	char magic[4];
+	int sizeOfBoard;
+	int emptyTileCell;
+	int depth;
+	unsigned long long numberOfSlots;
+};
+
+const char perimeterFileMagic[4] = { 'P', 'R', 'M', '1' };
+
+//distance of the packed tiles to the goal, -1 if it is farther than the perimeter
+inline int findPerimeter(const Perimeter& perimeter, const unsigned long long tiles) {
+	const unsigned long long key = tiles & perimeterKeyMask;
+	for (unsigned long long slot = mixBits(key) & perimeter.mask; ; slot = (slot + 1) & perimeter.mask) {
+		const unsigned long long entry = perimeter.entries[slot];
+		if (entry == 0) {
+			return -1;
+		}
+		else if ((entry & perimeterKeyMask) == key) {
+			return entry >> perimeterShift;
+		}
+	}
+}
+
+//breadth first search from the goal over the packed tiles, the layers are split between the threads, which claim
+//the slots of the table with compare and swap. The table is grown between the layers so that it stays at most half full
+const std::vector<unsigned long long> buildPerimeter(const Puzzle& puzzle, const int depth) {
+	const int numberOfCells = puzzle.numberOfCells;
+	const int* neightbourCells = puzzle.neightbourCells.data();
+	std::vector<std::atomic<unsigned long long>> table(1 << 10);
+	unsigned long long mask = table.size() - 1;
+	size_t numberOfEntries = 0;
+
+	auto insert = [&table, &mask](const unsigned long long entry) {
+		const unsigned long long key = entry & perimeterKeyMask;
+		for (unsigned long long slot = mixBits(key) & mask; ; slot = (slot + 1) & mask) {
+			unsigned long long current = table[slot].load(std::memory_order_relaxed);
+			while (current == 0) {
+				if (table[slot].compare_exchange_weak(current, entry, std::memory_order_relaxed)) {
+					return true;
+				}
+			}
+			if ((current & perimeterKeyMask) == key) {
+				return false;
+			}
+		}
+	};
+
+	std::vector<unsigned long long> layer(1, 0);
+	for (int tile = 1; tile < numberOfCells; tile++) {
+		const std::pair<int, int>& target = puzzle.targetPos[tile];
+		layer[0] |= static_cast<unsigned long long>(tile) << ((target.first * puzzle.sizeOfBoard + target.second) << 2);
+	}
+	insert(layer[0] & perimeterKeyMask);
+	numberOfEntries++;
+
+	for (int distance = 1; distance <= depth && !layer.empty(); distance++) {
+		//every board of the layer has at most 3 new neightbours
+		if (2 * (numberOfEntries + 3 * layer.size()) > table.size()) {
+			size_t size = table.size();
+			while (2 * (numberOfEntries + 3 * layer.size()) > size) {
+				size *= 2;
+			}
+			std::vector<std::atomic<unsigned long long>> old(size);
+			table.swap(old);
+			mask = size - 1;
+			for (const std::atomic<unsigned long long>& entry : old) {
+				if (entry.load(std::memory_order_relaxed) != 0) {
+					insert(entry.load(std::memory_order_relaxed));
+				}
+			}
+		}
+
+		std::vector<std::vector<unsigned long long>> outputs(numberOfThreads);
+		parallelFor(layer.size(), [&](const int thread, const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const unsigned long long tiles = layer[i];
+				int blank = 0;
+				while ((tiles >> (blank << 2)) & 0xF) {
+					blank++;
+				}
+				for (int j = 0; j < numberOfNeightbours; j++) {
+					const int cell = neightbourCells[blank * numberOfNeightbours + j];
+					if (cell == -1) {
+						continue;
+					}
+					const unsigned long long tile = (tiles >> (cell << 2)) & 0xF;
+					const unsigned long long next = tiles ^ (tile << (cell << 2)) ^ (tile << (blank << 2));
+					if (insert((next & perimeterKeyMask) | (static_cast<unsigned long long>(distance) << perimeterShift))) {
+						outputs[thread].push_back(next);
+					}
+				}
+			}
+		});
+
+		layer.clear();
+		for (const std::vector<unsigned long long>& part : outputs) {
+			layer.insert(layer.end(), part.begin(), part.end());
+		}
+		numberOfEntries += layer.size();
+	}
+
+	std::vector<unsigned long long> result(table.size());
+	for (size_t i = 0; i < table.size(); i++) {
+		result[i] = table[i].load(std::memory_order_relaxed);
+	}
+	return result;
+}
+
+const std::string getPerimeterFileName(const Puzzle& puzzle, const int depth) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	return patternDirectory + "/perimeter-" + std::to_string(sizeOfBoard) + "x" + std::to_string(sizeOfBoard) +
+		"-e" + std::to_string(puzzle.emptyTileTargetPos.first * sizeOfBoard + puzzle.emptyTileTargetPos.second) +
+		"-d" + std::to_string(depth) + ".bin";
+}
+
+const PerimeterFileHeader getPerimeterFileHeader(const Puzzle& puzzle, const int depth, const unsigned long long numberOfSlots) {
+	PerimeterFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, perimeterFileMagic, sizeof(header.magic));
+	header.sizeOfBoard = puzzle.sizeOfBoard;
+	header.emptyTileCell = puzzle.emptyTileTargetPos.first * puzzle.sizeOfBoard + puzzle.emptyTileTargetPos.second;
+	header.depth = depth;
+	header.numberOfSlots = numberOfSlots;
+	return header;
+}
+
+bool mapPerimeterFile(const Puzzle& puzzle, const std::string& fileName, Perimeter& perimeter) {
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat info;
+	PerimeterFileHeader header;
+	if (fstat(fd, &info) == -1 || static_cast<size_t>(info.st_size) < sizeof(header) ||
+		read(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+		close(fd);
+		return false;
+	}
+	const PerimeterFileHeader expected = getPerimeterFileHeader(puzzle, perimeter.depth, header.numberOfSlots);
+	const size_t expectedSize = sizeof(header) + header.numberOfSlots * sizeof(unsigned long long);
+	if (std::memcmp(&header, &expected, sizeof(header)) != 0 || static_cast<size_t>(info.st_size) != expectedSize ||
+		header.numberOfSlots == 0 || (header.numberOfSlots & (header.numberOfSlots - 1)) != 0) {
+		close(fd);
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, expectedSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	perimeter.mapping = mapping;
+	perimeter.mappingSize = expectedSize;
+	perimeter.entries = reinterpret_cast<const unsigned long long*>(static_cast<const char*>(mapping) + sizeof(header));
+	perimeter.mask = header.numberOfSlots - 1;
+	return true;
+}
+
+bool setUpPerimeter(Puzzle& puzzle) {
+	Perimeter& perimeter = puzzle.perimeter;
+	perimeter.depth = std::min(perimeterDepth, maxPerimeterDepth);
+	if (puzzle.sizeOfBoard > 4) {
+		std::cerr << "The perimeter search needs a board up to 4x4." << std::endl;
+		perimeter.depth = 0;
+		return false;
+	}
+
+	const std::string fileName = getPerimeterFileName(puzzle, perimeter.depth);
+	if (mapPerimeter && mapPerimeterFile(puzzle, fileName, perimeter)) {
+		return true;
+	}
 
-	while (!history.empty()) {
-		switch (history.top()) {
-		case up: std::cout << "up"; break;
-		case down: std::cout << "down"; break;
-		case right: std::cout << "right"; break;
-		case left: std::cout << "left"; break;
+	perimeter.storage = buildPerimeter(puzzle, perimeter.depth);
+	perimeter.entries = perimeter.storage.data();
+	perimeter.mask = perimeter.storage.size() - 1;
+	if (mapPerimeter) {
+		const PerimeterFileHeader header = getPerimeterFileHeader(puzzle, perimeter.depth, perimeter.storage.size());
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(perimeter.storage.data()), perimeter.storage.size() * sizeof(unsigned long long));
+		file.close();
+		if (!file) {
+			std::cerr << "Could not save the perimeter " << fileName << std::endl;
 		}
-		history.pop();
-		if (!history.empty()) {
-			std::cout << std::endl;
+	}
+	return true;
+}
+
+void releasePerimeter(Puzzle& puzzle) {
+	Perimeter& perimeter = puzzle.perimeter;
+	if (perimeter.mapping != nullptr) {
+		munmap(perimeter.mapping, perimeter.mappingSize);
+		perimeter.mapping = nullptr;
+	}
+	perimeter.storage.clear();
+	perimeter.depth = 0;
+}
+
+//the moves from the board in the perimeter to the goal, every step goes to a neightbour one move closer
+template <class Board>
+void appendPerimeterPath(const Puzzle& puzzle, Board board, int distance, std::vector<Move>& moves) {
+	for (; distance > 0; distance--) {
+		const int blank = board.blank;
+		for (int i = 0; i < numberOfNeightbours; i++) {
+			const int cell = puzzle.neightbourCells[blank * numberOfNeightbours + i];
+			if (cell == -1) {
+				continue;
+			}
+			board.slide(cell);
+			if (findPerimeter(puzzle.perimeter, board.tiles) == distance - 1) {
+				moves.push_back(static_cast<Move>(i));
+				break;
+			}
+			board.slide(blank);
 		}
+	}
+}
+
+//duplicate pruning with a finite state machine (Taylor & Korf) - move sequences of the blank up to duplicateDepth
+//are enumerated in (length, lexicographic) order on an unbounded board, a sequence that leads to the same tiles
+//and blank as an earlier one is a duplicate. The earlier one is kept only if the blank stays inside the rectangle
+//the duplicate walks through, so it can always replace it on the real board. An Aho-Corasick automaton over the
+//duplicates rejects every path that contains one. The smallest path to any state never does, so the search stays
+//optimal. With depth 2 the duplicates are exactly the back moves. The number of sequences grows about 3 times with every
+//move (depth 12 takes about a second, 14 about ten), and a sequence has to fit in a word, so the depth is at most 14
+int duplicateDepth = 2;
+const int maxDuplicateDepth = 14;
+int* duplicateTransitions; //state * numberOfNeightbours + move -> next state, -1 if the path ends with a duplicate
+
+//a sequence of moves is kept in a word - 2 bits per move with the last one lowest and the length in the top byte
+inline unsigned long long appendMove(const unsigned long long sequence, const int move) {
+	return ((sequence >> 56) + 1) << 56 | (sequence << 2 & 0x00FFFFFFFFFFFFFFull) | move;
+}
+
+const std::string getSequenceMoves(const unsigned long long sequence) {
+	const int length = sequence >> 56;
+	std::string moves(length, 0);
+	for (int i = 0; i < length; i++) {
+		moves[length - 1 - i] = (sequence >> (2 * i)) & 3;
+	}
+	return moves;
+}
+
+struct SequenceBounds {
+	int minRow, maxRow, minCol, maxCol; //rectangle of the cells the blank visited
+};
 
+struct EffectHash {
+	size_t operator()(const std::pair<unsigned long long, unsigned long long>& effect) const {
+		return effect.first;
 	}
+};
 
-	for (int i = 0; i < sizeOfBoard; i++) {
-		delete[] board[i];
+//the effect of the moves - the final cell of the blank and every tile that is not where it started, hashed twice
+//with 64 bits, which makes a collision practically impossible. The coordinates are relative to the start of the blank
+const std::pair<unsigned long long, unsigned long long> getSequenceEffect(const unsigned long long sequence, SequenceBounds& bounds) {
+	const int length = sequence >> 56;
+	int cells[64][2]; //cell of the board -> the cell its tile started from
+	int numberOfTouched = 1;
+	std::pair<int, int> blank(0, 0);
+	cells[0][0] = cells[0][1] = 32 * 64 + 32;
+	bounds = SequenceBounds{ 0, 0, 0, 0 };
+
+	int blankIdx = 0;
+	for (int i = length - 1; i >= 0; i--) {
+		blank = nextTile(blank, static_cast<Move>((sequence >> (2 * i)) & 3));
+		const int cell = (blank.first + 32) * 64 + blank.second + 32;
+		int nextIdx = 0;
+		while (nextIdx < numberOfTouched && cells[nextIdx][0] != cell) {
+			nextIdx++;
+		}
+		if (nextIdx == numberOfTouched) {
+			cells[numberOfTouched][0] = cells[numberOfTouched][1] = cell;
+			numberOfTouched++;
+		}
+		std::swap(cells[blankIdx][1], cells[nextIdx][1]);
+		blankIdx = nextIdx;
+		bounds.minRow = std::min(bounds.minRow, blank.first);
+		bounds.maxRow = std::max(bounds.maxRow, blank.first);
+		bounds.minCol = std::min(bounds.minCol, blank.second);
+		bounds.maxCol = std::max(bounds.maxCol, blank.second);
+	}
+
+	std::pair<unsigned long long, unsigned long long> effect(mixBits(cells[blankIdx][0]), mixBits(cells[blankIdx][0] + 0x9E3779B97F4A7C15ull));
+	for (int i = 0; i < numberOfTouched; i++) {
+		if (cells[i][0] != cells[i][1]) {
+			const unsigned long long key = static_cast<unsigned long long>(cells[i][0]) << 32 | cells[i][1];
+			effect.first ^= mixBits(key * 0xD6E8FEB86659FD93ull);
+			effect.second += mixBits(key ^ 0xA0761D6478BD642Full);
+		}
 	}
-	delete[] board;
+	return effect;
+}
+
+//Aho-Corasick automaton - a trie of the duplicates and failure links, a transition goes to -1 when the path ends with one
+const std::vector<int> buildDuplicateAutomaton(const std::vector<std::string>& duplicates) {
+	std::vector<int> children(numberOfNeightbours, -1);
+	std::vector<bool> rejecting(1, false);
+	for (const std::string& moves : duplicates) {
+		int state = 0;
+		for (const char move : moves) {
+			if (children[state * numberOfNeightbours + move] == -1) {
+				children[state * numberOfNeightbours + move] = rejecting.size();
+				rejecting.push_back(false);
+				children.insert(children.end(), numberOfNeightbours, -1);
+			}
+			state = children[state * numberOfNeightbours + move];
+		}
+		rejecting[state] = true;
+	}
+
+	std::vector<int> failure(rejecting.size(), 0);
+	std::vector<int> order(1, 0);
+	for (size_t i = 0; i < order.size(); i++) {
+		const int state = order[i];
+		for (int move = 0; move < numberOfNeightbours; move++) {
+			const int child = children[state * numberOfNeightbours + move];
+			if (child == -1) {
+				children[state * numberOfNeightbours + move] = state == 0 ? 0 : children[failure[state] * numberOfNeightbours + move];
+				continue;
+			}
+			failure[child] = state == 0 ? 0 : children[failure[state] * numberOfNeightbours + move];
+			rejecting[child] = rejecting[child] || rejecting[failure[child]];
+			order.push_back(child);
+		}
+	}
+
+	for (int& child : children) {
+		child = rejecting[child] ? -1 : child;
+	}
+	return children;
+}
+
+const std::vector<std::string> findDuplicateSequences() {
+	std::vector<std::string> duplicates;
+	std::unordered_map<std::pair<unsigned long long, unsigned long long>, SequenceBounds, EffectHash> reached;
+	std::vector<unsigned long long> layer(1, 0);
+	SequenceBounds bounds;
+	reached[getSequenceEffect(0, bounds)] = bounds;
+
+	for (int depth = 1; depth <= duplicateDepth; depth++) {
+		//paths with a shorter duplicate at the end are already rejected by the automaton
+		const std::vector<int>& transitions = buildDuplicateAutomaton(duplicates);
+		std::vector<unsigned long long> next;
+		reached.reserve(reached.size() + layer.size() * 3);
+		for (const unsigned long long parent : layer) {
+			int state = 0;
+			for (int i = depth - 2; i >= 0; i--) {
+				state = transitions[state * numberOfNeightbours + ((parent >> (2 * i)) & 3)];
+			}
+
+			for (int i = 0; i < numberOfNeightbours; i++) {
+				if (transitions[state * numberOfNeightbours + i] == -1) {
+					continue;
+				}
+
+				const unsigned long long sequence = appendMove(parent, i);
+				const std::pair<unsigned long long, unsigned long long> effect = getSequenceEffect(sequence, bounds);
+				std::unordered_map<std::pair<unsigned long long, unsigned long long>, SequenceBounds, EffectHash>::const_iterator earlier = reached.find(effect);
+				if (earlier == reached.end()) {
+					if (depth < duplicateDepth) {
+						reached[effect] = bounds;
+					}
+				}
+				else if (earlier->second.minRow >= bounds.minRow && earlier->second.maxRow <= bounds.maxRow &&
+					earlier->second.minCol >= bounds.minCol && earlier->second.maxCol <= bounds.maxCol) {
+					duplicates.push_back(getSequenceMoves(sequence));
+					continue;
+				}
+				next.push_back(sequence);
+			}
+		}
+		layer.swap(next);
+	}
+	return duplicates;
+}
+
+//every automaton rejects at least the back moves, the duplicates of length 2 have to be exactly them
+bool hasBackMoves(const std::vector<std::string>& duplicates) {
+	std::vector<std::string> pairs;
+	for (const std::string& moves : duplicates) {
+		if (moves.size() == 2) {
+			pairs.push_back(moves);
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+	std::vector<std::string> backMoves;
+	for (int i = 0; i < numberOfNeightbours; i++) {
+		backMoves.push_back(std::string{ static_cast<char>(i), static_cast<char>(getOppositeMove(static_cast<Move>(i))) });
+	}
+	std::sort(backMoves.begin(), backMoves.end());
+	return pairs == backMoves;
+}
+
+void setUpDuplicateAutomaton() {
+	const std::vector<std::string>& duplicates = findDuplicateSequences();
+	assert(hasBackMoves(duplicates));
+	const std::vector<int>& transitions = buildDuplicateAutomaton(duplicates);
+	duplicateTransitions = new int[transitions.size()];
+	std::copy(transitions.begin(), transitions.end(), duplicateTransitions);
+}
+
+
+//transposition table - one atomic word per entry, the upper 36 bits of the hash, the iteration and the smallest
+//path length the state was reached with in it. A state reached again with a longer path is not expanded, with
+//the same length only when the automaton rejects nothing but back moves - otherwise the two paths end in different
+//states of the automaton, and the moves the second one may continue with can be rejected after the first one
+bool useTranspositionTable = false;
+int transpositionBits = 22;
+
+//state of one solver - the threads of a parallel search share it, separate solvers need separate contexts
+struct SearchContext {
+	std::atomic<bool> aborted;
+	std::atomic<unsigned long long>* transpositionTable;
+	int iteration; //20 bits of the tag, the table is cleared when they wrap, so the entries of earlier searches never match
+
+	SearchContext() : aborted(false), transpositionTable(nullptr), iteration(0) {
+		if (useTranspositionTable) {
+			transpositionTable = new std::atomic<unsigned long long>[1ull << transpositionBits];
+			clearTranspositions();
+		}
+	}
+
+	void clearTranspositions() {
+		for (unsigned long long i = 0; i < (1ull << transpositionBits); i++) {
+			transpositionTable[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	//0 is skipped, an empty entry would match it
+	void nextIteration() {
+		iteration = (iteration + 1) & 0xFFFFF;
+		if (iteration == 0) {
+			if (transpositionTable != nullptr) {
+				clearTranspositions();
+			}
+			iteration = 1;
+		}
+	}
+
+	~SearchContext() {
+		delete[] transpositionTable;
+	}
+};
+
+//false if the state was already reached with a shorter path in this iteration, paths up to 255
+inline bool visitTransposition(SearchContext& context, const unsigned long long hash, const int path) {
+	std::atomic<unsigned long long>& entry = context.transpositionTable[hash & ((1ull << transpositionBits) - 1)];
+	const unsigned long long tag = (hash >> 28 << 28) | static_cast<unsigned long long>(context.iteration) << 8;
+	const unsigned long long current = entry.load(std::memory_order_relaxed);
+	if ((current & ~0xFFull) == tag) {
+		const int reachedPath = current & 0xFF;
+		if (reachedPath < path || (reachedPath == path && duplicateDepth <= 2)) {
+			return false;
+		}
+	}
+	entry.store(tag | path, std::memory_order_relaxed);
+	return true;
+}
+
+//one node on the path of the search - the frames are kept in an array that grows only between the iterations
+struct SearchFrame {
+	int blank;
+	int heuristic;
+	int duplicateState;
+	int nextMove; //the next move of the blank to try from this node
+	Move move; //the move that led to this node
+};
+
+//the board and the path of one search over a shared puzzle
+template <class Board>
+struct SearchState {
+	const Puzzle* puzzle;
+	SearchContext* context;
+	Board board;
+	std::vector<SearchFrame> path;
+	std::vector<Move> moves; //the solution once it is found
+	long long expandedNodes;
+	long long generatedNodes;
+	int maxDepth; //of the deepest generated node
+};
+
+//where the blank goes with the move, -1 outside of the board
+template <class Board>
+inline int getNeightbourCell(const Puzzle& puzzle, const int cell, const int move) {
+	if constexpr (Board::width != 0) {
+		return fixedTables<Board::width>.neightbourCells[cell * numberOfNeightbours + move];
+	}
+	else {
+		return puzzle.neightbourCells[cell * numberOfNeightbours + move];
+	}
+}
+
+//the manhattan deltas for the goal of the puzzle, taken once per search and not on every node
+template <class Board>
+inline auto getManhattanDeltas(const Puzzle& puzzle) {
+	if constexpr (Board::width != 0) {
+		return fixedTables<Board::width>.manhattanDelta[puzzle.emptyTileTargetPos.first * Board::width + puzzle.emptyTileTargetPos.second];
+	}
+	else {
+		return puzzle.manhattanDelta.data();
+	}
+}
+
+//change of the heuristic when the blank makes the move and the tile from its neightbour cell takes its place
+template <class Board, typename Delta>
+inline int getHeuristicDelta(const Puzzle& puzzle, const Board& board, const Delta* manhattanDeltas, const int tile, const int from,
+	const int move) {
+	const int numberOfCells = Board::width != 0 ? Board::width * Board::width : puzzle.numberOfCells;
+	int delta;
+	if constexpr (Board::width != 0) {
+		delta = manhattanDeltas[tile].deltas[from * numberOfNeightbours + move];
+	}
+	else {
+		delta = manhattanDeltas[(tile * numberOfCells + from) * numberOfNeightbours + move];
+	}
+	if constexpr (Board::heuristic == withPatternDatabases) {
+		delta += getPatternDelta(puzzle, board, tile, board.blank);
+	}
+	if constexpr (Board::heuristic == withLinearConflict) {
+		delta += getLinearConflictDelta(puzzle, board, tile, from, board.blank);
+	}
+	return delta;
+}
+
+template <class Board>
+int calculateHeuristic(const Puzzle& puzzle, const Board& board) {
+	return calculateManhattan(puzzle, board) + (puzzle.usePatternDatabase ? calculatePatternDatabases(puzzle, board) : 0) +
+		(puzzle.useLinearConflict ? calculateLinearConflict(puzzle, board) : 0);
+}
+
+//depth first search below the root up to the threshold with an explicit stack of frames instead of recursion.
+//rootPath is the number of moves already made before the root. Returns 0 when the goal is found (the moves after
+//the root are in state.moves), otherwise the smallest cost over the threshold. The board is restored in both cases
+template <class Board>
+int search(SearchState<Board>& state, const int rootPath, const int threshold, const Move rootMove, const int rootDuplicateState,
+	const int rootHeuristic) {
+	const int rootCost = rootHeuristic + rootPath;
+	if (rootCost > threshold) {
+		return rootCost;
+	}
+	else if (rootHeuristic == 0) {
+		state.moves.clear();
+		return 0;
+	}
+
+	//no path below the root is longer than threshold - rootPath, so the frames never run out
+	if (state.path.size() < static_cast<size_t>(threshold - rootPath + 1)) {
+		state.path.resize(threshold - rootPath + 1);
+	}
+	const Puzzle& puzzle = *state.puzzle;
+	SearchContext& context = *state.context;
+	Board& board = state.board;
+	SearchFrame* path = state.path.data();
+	path[0] = SearchFrame{ board.blank, rootHeuristic, rootDuplicateState, 0, rootMove };
+
+	if (context.aborted.load(std::memory_order_relaxed) ||
+		(useTranspositionTable && rootPath <= 0xFF && !visitTransposition(context, board.hash(), rootPath))) {
+		return INT32_MAX;
+	}
+
+	//everything the nodes read is taken into locals once - the stores to the board and the frames would make the
+	//compiler load it again on every node. The counters are added to the state at the end for the same reason
+	const auto manhattanDeltas = getManhattanDeltas<Board>(puzzle);
+	const int* transitions = duplicateTransitions;
+	const int perimeterRadius = puzzle.perimeter.depth;
+	const bool transpositions = useTranspositionTable;
+	long long expandedNodes = 1;
+	long long generatedNodes = 0;
+	int deepest = 0; //depth of the deepest expanded node
+
+	int min = INT32_MAX;
+	int depth = 0;
+	int result;
+	while (true) {
+		SearchFrame& frame = path[depth];
+		if (frame.nextMove == numberOfNeightbours) {
+			if (depth == 0) {
+				result = min;
+				break;
+			}
+			depth--;
+			board.slide(path[depth].blank);
+			continue;
+		}
+
+		const int i = frame.nextMove++;
+		const int neightbour = getNeightbourCell<Board>(puzzle, frame.blank, i);
+		const int nextState = transitions[frame.duplicateState * numberOfNeightbours + i];
+		if (nextState == -1 || neightbour == -1) {
+			continue;
+		}
+		generatedNodes++;
+
+		const int childHeuristic = frame.heuristic + getHeuristicDelta(puzzle, board, manhattanDeltas, board.tileAt(neightbour), neightbour, i);
+		const int childPath = rootPath + depth + 1;
+		const int cost = childHeuristic + childPath;
+		if (cost > threshold) {
+			min = std::min(min, cost);
+			continue;
+		}
+
+		board.slide(neightbour);
+		depth++;
+		path[depth] = SearchFrame{ neightbour, childHeuristic, nextState, 0, static_cast<Move>(i) };
+		if (childHeuristic == 0) {
+			state.moves.resize(depth);
+			for (; depth > 0; depth--) {
+				state.moves[depth - 1] = path[depth].move;
+				board.slide(path[depth - 1].blank);
+			}
+			result = 0;
+			break;
+		}
+		else if constexpr (Board::packed) {
+			//a solution within the threshold goes through a board in the perimeter at this depth, so the deeper
+			//layers are never searched
+			if (perimeterRadius > 0 && childPath >= threshold - perimeterRadius) {
+				const int distance = childHeuristic <= perimeterRadius ? findPerimeter(puzzle.perimeter, board.tiles) : -1;
+				//the exact cost, or a bound from the perimeter if the board is outside of it - every path to the goal
+				//has the parity of the heuristic
+				const int outside = perimeterRadius + 1 + ((perimeterRadius + 1 - childHeuristic) & 1);
+				const int perimeterCost = childPath + (distance == -1 ? std::max(outside, childHeuristic) : distance);
+				if (distance != -1 && perimeterCost <= threshold) {
+					state.moves.resize(depth);
+					appendPerimeterPath(puzzle, board, distance, state.moves);
+					for (; depth > 0; depth--) {
+						state.moves[depth - 1] = path[depth].move;
+						board.slide(path[depth - 1].blank);
+					}
+					result = 0;
+					break;
+				}
+				else if (distance != -1 || perimeterCost > threshold) {
+					min = std::min(min, perimeterCost);
+					depth--;
+					board.slide(path[depth].blank);
+					continue;
+				}
+			}
+		}
+		if (context.aborted.load(std::memory_order_relaxed)) {
+			//another thread found the solution, the value is ignored
+			for (; depth > 0; depth--) {
+				board.slide(path[depth - 1].blank);
+			}
+			result = INT32_MAX;
+			break;
+		}
+		else if (transpositions && childPath <= 0xFF && !visitTransposition(context, board.hash(), childPath)) {
+			depth--;
+			board.slide(path[depth].blank);
+			continue;
+		}
+		expandedNodes++;
+		deepest = std::max(deepest, depth);
+	}
+
+	state.expandedNodes += expandedNodes;
+	state.generatedNodes += generatedNodes;
+	state.maxDepth = std::max(state.maxDepth, rootPath + deepest + 1);
+	return result;
+}
+
+//parallel IDA* - every iteration the root is expanded to parallelDepth and the subtrees are searched by the workers
+bool useParallelSearch = false;
+int parallelDepth = 10;
+
+struct FrontierNode {
+	std::vector<Move> moves; //from the root, the last one is the prevMove of the node
+	int duplicateState;
+	int heuristic;
+};
+
+//lock-free deque over a fixed range of frontier indices - nothing is pushed while the workers run,
+//so top and bottom fit in one atomic word, the owner takes from the bottom, thieves from the top
+struct StealingDeque {
+	std::atomic<unsigned long long> range;
+
+	void reset(const unsigned int top, const unsigned int bottom) {
+		range.store((static_cast<unsigned long long>(top) << 32) | bottom);
+	}
+
+	bool pop(int& index, const bool steal) {
+		unsigned long long current = range.load();
+		while (true) {
+			const unsigned int top = current >> 32;
+			const unsigned int bottom = current & 0xFFFFFFFF;
+			if (top >= bottom) {
+				return false;
+			}
+			const unsigned long long next = steal ? (static_cast<unsigned long long>(top + 1) << 32) | bottom :
+				(static_cast<unsigned long long>(top) << 32) | (bottom - 1);
+			if (range.compare_exchange_weak(current, next)) {
+				index = steal ? top : bottom - 1;
+				return true;
+			}
+		}
+	}
+};
+
+inline void updateMin(std::atomic<int>& min, const int value) {
+	int current = min.load(std::memory_order_relaxed);
+	while (value < current && !min.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+//same cutoffs as search, the nodes at parallelDepth are collected instead of searched,
+//returns true if the solution is shallower than the frontier
+template <class Board>
+bool collectFrontier(SearchState<Board>& state, std::vector<Move>& moves, const int threshold, const int duplicateState, const int heuristic,
+	std::vector<FrontierNode>& frontier, int& min) {
+	const int cost = heuristic + moves.size();
+
+	if (cost > threshold) {
+		min = std::min(min, cost);
+		return false;
+	}
+	else if (heuristic == 0) {
+		return true;
+	}
+	else if (moves.size() == static_cast<size_t>(parallelDepth)) {
+		frontier.push_back(FrontierNode{ moves, duplicateState, heuristic });
+		return false;
+	}
+	state.expandedNodes++;
+	state.maxDepth = std::max<int>(state.maxDepth, moves.size() + 1);
+
+	const Puzzle& puzzle = *state.puzzle;
+	Board& board = state.board;
+	const int emptyTile = board.blank;
+	for (int i = 0; i < numberOfNeightbours; i++) {
+		const int neightbour = getNeightbourCell<Board>(puzzle, emptyTile, i);
+		const int nextState = duplicateTransitions[duplicateState * numberOfNeightbours + i];
+		if (nextState == -1 || neightbour == -1) {
+			continue;
+		}
+		state.generatedNodes++;
+
+		const int childHeuristic = heuristic + getHeuristicDelta(puzzle, board, getManhattanDeltas<Board>(puzzle), board.tileAt(neightbour), neightbour, i);
+		moves.push_back(static_cast<Move>(i));
+		board.slide(neightbour);
+		const bool found = collectFrontier(state, moves, threshold, nextState, childHeuristic, frontier, min);
+		board.slide(emptyTile);
+		if (found) {
+			return true;
+		}
+		moves.pop_back();
+	}
+	return false;
+}
+
+template <class Board>
+int parallelSearch(SearchState<Board>& root, const int threshold, const int startHeuristic) {
+	const Puzzle& puzzle = *root.puzzle;
+	SearchContext& context = *root.context;
+	std::vector<FrontierNode> frontier;
+	std::vector<Move> moves;
+	int min = INT32_MAX;
+	if (collectFrontier(root, moves, threshold, 0, startHeuristic, frontier, min)) {
+		root.moves = moves;
+		return 0;
+	}
+
+	std::vector<StealingDeque> deques(numberOfThreads);
+	for (int i = 0; i < numberOfThreads; i++) {
+		deques[i].reset(frontier.size() * i / numberOfThreads, frontier.size() * (i + 1) / numberOfThreads);
+	}
+
+	std::atomic<int> nextThreshold(min);
+	std::vector<SearchState<Board>> workers(numberOfThreads, SearchState<Board>{ &puzzle, &context, root.board, std::vector<SearchFrame>(),
+		std::vector<Move>(), 0, 0, 0 });
+	context.aborted.store(false);
+	auto work = [&](const int workerIdx) {
+		SearchState<Board>& state = workers[workerIdx];
+		int index;
+		while (!context.aborted.load(std::memory_order_relaxed)) {
+			bool taken = deques[workerIdx].pop(index, false);
+			for (int i = 1; !taken && i < numberOfThreads; i++) {
+				taken = deques[(workerIdx + i) % numberOfThreads].pop(index, true);
+			}
+			if (!taken) {
+				return;
+			}
+
+			//every worker replays the moves of the node on its own copy of the board
+			const FrontierNode& node = frontier[index];
+			state.board = root.board;
+			for (const Move move : node.moves) {
+				state.board.slide(getNeightbourCell<Board>(puzzle, state.board.blank, move));
+			}
+
+			const int answer = search(state, node.moves.size(), threshold, node.moves.back(), node.duplicateState, node.heuristic);
+			if (answer == 0) {
+				//only the first thread to find a solution writes it
+				if (!context.aborted.exchange(true)) {
+					root.moves = node.moves;
+					root.moves.insert(root.moves.end(), state.moves.begin(), state.moves.end());
+				}
+				return;
+			}
+			updateMin(nextThreshold, answer);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < numberOfThreads; i++) {
+		threads.emplace_back(work, i);
+	}
+	work(0);
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	for (const SearchState<Board>& state : workers) {
+		root.expandedNodes += state.expandedNodes;
+		root.generatedNodes += state.generatedNodes;
+		root.maxDepth = std::max(root.maxDepth, state.maxDepth);
+	}
+	return context.aborted.load() ? 0 : nextThreshold.load();
+}
+
+//effective branching factor - b with b + b^2 + ... + b^depth = generated nodes, found by bisection
+double getBranchingFactor(const long long generatedNodes, const int depth) {
+	if (depth == 0 || generatedNodes == 0) {
+		return 0;
+	}
+
+	double low = 0;
+	double high = std::max<double>(1, generatedNodes);
+	for (int step = 0; step < 64; step++) {
+		const double middle = (low + high) / 2;
+		double sum = 0;
+		double power = 1;
+		for (int i = 0; i < depth && sum <= generatedNodes; i++) {
+			power *= middle;
+			sum += power;
+		}
+		if (sum > generatedNodes) {
+			high = middle;
+		}
+		else {
+			low = middle;
+		}
+	}
+	return low;
+}
+
+struct IterationStats {
+	int threshold;
+	long long expandedNodes;
+	long long generatedNodes;
+	int maxDepth;
+	double branchingFactor;
+	long long time; //microseconds
+};
+
+struct Solution {
+	std::vector<Move> moves;
+	int lowerBound; //proven for the length of the optimal solution
+	long long expandedNodes;
+	long long generatedNodes;
+	std::vector<IterationStats> iterations;
+};
+
+//one threshold iteration with its telemetry, returns 0 if the solution was found, otherwise the next threshold
+template <class Board>
+int runIteration(SearchState<Board>& state, const int threshold, const int startHeuristic, Solution& solution) {
+	//std::cout << "threshold :" << threshold << std::endl;
+	state.context->nextIteration();
+	const long long expandedBefore = state.expandedNodes;
+	const long long generatedBefore = state.generatedNodes;
+	state.maxDepth = 0;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	int answer = useParallelSearch ? parallelSearch(state, threshold, startHeuristic) :
+		search(state, 0, threshold, none, 0, startHeuristic);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	IterationStats stats{ threshold, state.expandedNodes - expandedBefore, state.generatedNodes - generatedBefore, state.maxDepth, 0,
+		std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() };
+	stats.branchingFactor = getBranchingFactor(stats.generatedNodes, stats.maxDepth);
+	solution.iterations.push_back(stats);
+	solution.expandedNodes = state.expandedNodes;
+	solution.generatedNodes = state.generatedNodes;
+	return answer;
+}
+
+//bounded-suboptimal anytime search - weighted A* (best first by g + w * h) finds a path at most w times longer than
+//the optimal one. Without a time limit that path is the answer. With a time limit the weight is halved towards 1
+//while there is time, and the last phase is IDA* bounded by the best path - every iteration it finishes raises the
+//lower bound, and when the bound reaches the path the path is optimal. The first path is always waited for, but when
+//the deadline passes without it the weight goes up to expiredWeight, so the answer is late by a greedy search at most
+int anytimeWeight = 0; //in 1/256, 0 when the anytime search is off
+long long anytimeLimit = -1; //milliseconds, -1 without a limit
+const int defaultAnytimeWeight = 2 * 256;
+const int expiredWeight = 2 * 256;
+const int anytimeNodeLimit = 1 << 21; //of a weighted A* phase, the weight is doubled when the first one runs out
+std::mutex reportMutex;
+
+struct WeightedNode {
+	int parent;
+	int path;
+	int heuristic;
+	Move move;
+	bool closed;
+};
+
+//the nodes keep only the move from their parent, the board of a node is rebuilt by replaying the moves from the
+//start. Paths that cannot be shorter than limit are cut. False when the node limit is reached or the deadline passed
+template <class Board>
+bool weightedSearch(SearchState<Board>& state, const int startHeuristic, const int weight, const int limit, std::vector<Move>& result) {
+	const Puzzle& puzzle = *state.puzzle;
+	SearchContext& context = *state.context;
+	const auto manhattanDeltas = getManhattanDeltas<Board>(puzzle);
+	std::vector<WeightedNode> nodes(1, WeightedNode{ -1, 0, startHeuristic, none, false });
+	//hash of the board -> node, open addressing in one flat array - it is freed at once when the deadline passes
+	std::vector<std::pair<unsigned long long, int>> reached(1 << 16, std::make_pair(0ull, -1));
+	auto findSlot = [&reached](const unsigned long long key) -> std::pair<unsigned long long, int>& {
+		size_t slot = key & (reached.size() - 1);
+		while (reached[slot].second != -1 && reached[slot].first != key) {
+			slot = (slot + 1) & (reached.size() - 1);
+		}
+		return reached[slot];
+	};
+	std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>, std::greater<std::pair<long long, int>>> open;
+	//ties go to the longer path
+	auto getPriority = [weight](const int path, const int heuristic) {
+		return (static_cast<long long>(path) * 256 + static_cast<long long>(heuristic) * weight) * 1024 - path;
+	};
+	findSlot(state.board.hash()) = std::make_pair(state.board.hash(), 0);
+	open.push(std::make_pair(getPriority(0, startHeuristic), 0));
+
+	Board board;
+	std::vector<Move> moves;
+	while (!open.empty()) {
+		if (nodes.size() >= anytimeNodeLimit || context.aborted.load(std::memory_order_relaxed)) {
+			return false;
+		}
+		const int index = open.top().second;
+		open.pop();
+		if (nodes[index].closed) {
+			continue;
+		}
+		nodes[index].closed = true;
+		const WeightedNode node = nodes[index];
+
+		moves.clear();
+		for (int i = index; nodes[i].parent != -1; i = nodes[i].parent) {
+			moves.push_back(nodes[i].move);
+		}
+		if (node.heuristic == 0) {
+			result.assign(moves.rbegin(), moves.rend());
+			return true;
+		}
+		board = state.board;
+		for (int i = moves.size() - 1; i >= 0; i--) {
+			board.slide(getNeightbourCell<Board>(puzzle, board.blank, moves[i]));
+		}
+		state.expandedNodes++;
+
+		const int emptyTile = board.blank;
+		for (int i = 0; i < numberOfNeightbours; i++) {
+			const int neightbour = getNeightbourCell<Board>(puzzle, emptyTile, i);
+			if (neightbour == -1 || (node.move != none && i == getOppositeMove(node.move))) {
+				continue;
+			}
+			state.generatedNodes++;
+
+			const int childHeuristic = node.heuristic + getHeuristicDelta(puzzle, board, manhattanDeltas, board.tileAt(neightbour), neightbour, i);
+			const int childPath = node.path + 1;
+			if (childPath + childHeuristic >= limit) {
+				continue;
+			}
+			board.slide(neightbour);
+			const unsigned long long key = board.hash();
+			board.slide(emptyTile);
+
+			std::pair<unsigned long long, int>& found = findSlot(key);
+			if (found.second == -1) {
+				found = std::make_pair(key, static_cast<int>(nodes.size()));
+				nodes.push_back(WeightedNode{ index, childPath, childHeuristic, static_cast<Move>(i), false });
+				open.push(std::make_pair(getPriority(childPath, childHeuristic), nodes.size() - 1));
+			}
+			else if (nodes[found.second].path > childPath) {
+				nodes[found.second] = WeightedNode{ index, childPath, childHeuristic, static_cast<Move>(i), false };
+				open.push(std::make_pair(getPriority(childPath, childHeuristic), found.second));
+			}
+		}
+
+		if (nodes.size() * 2 > reached.size()) {
+			std::vector<std::pair<unsigned long long, int>> entries(reached.size() * 2, std::make_pair(0ull, -1));
+			entries.swap(reached);
+			for (const std::pair<unsigned long long, int>& entry : entries) {
+				if (entry.second != -1) {
+					findSlot(entry.first) = entry;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+//every improvement goes to stderr: <puzzle id> <time in milliseconds> <length> <lower bound> <moves>
+void reportImprovement(const long long id, const std::chrono::steady_clock::time_point& begin, const Solution& solution) {
+	std::string line = std::to_string(id) + " " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - begin).count()) + " " + std::to_string(solution.moves.size()) + " " + std::to_string(solution.lowerBound);
+	for (const Move move : solution.moves) {
+		line += ' ';
+		line += getMoveName(move);
+	}
+	line += '\n';
+
+	std::lock_guard<std::mutex> lock(reportMutex);
+	std::cerr << line << std::flush;
+}
+
+template <class Board>
+void anytimeSearch(SearchState<Board>& state, const int startHeuristic, Solution& solution, const long long id, const Solution* incumbent) {
+	SearchContext& context = *state.context;
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	std::mutex watchdogMutex;
+	std::condition_variable watchdog;
+	bool finished = false;
+	std::thread timer;
+	if (anytimeLimit != -1) {
+		timer = std::thread([&]() {
+			std::unique_lock<std::mutex> lock(watchdogMutex);
+			if (!watchdog.wait_until(lock, begin + std::chrono::milliseconds(anytimeLimit), [&finished]() { return finished; })) {
+				context.aborted.store(true);
+			}
+		});
+	}
+
+	//a path from an earlier search is refined like the first path of this one
+	bool found = incumbent != nullptr;
+	solution.lowerBound = startHeuristic;
+	if (found) {
+		solution.moves = incumbent->moves;
+		solution.lowerBound = std::max(startHeuristic, incumbent->lowerBound);
+		reportImprovement(id, begin, solution);
+	}
+	std::vector<Move> moves;
+	bool expired = false; //the deadline passed before the first path
+	//weights close to 1 are left to IDA*, but with a time limit the first path always comes from weighted A*
+	const int firstWeight = anytimeLimit == -1 ? anytimeWeight : std::max(anytimeWeight, 256 + 32);
+	for (int weight = firstWeight; weight >= 256 + 32 && (!found || !context.aborted.load()); weight = 256 + (weight - 256) / 2) {
+		const bool reached = weightedSearch(state, startHeuristic, weight, found ? solution.moves.size() : INT32_MAX, moves);
+		solution.expandedNodes = state.expandedNodes;
+		solution.generatedNodes = state.generatedNodes;
+		if (!reached) {
+			if (found) {
+				break;
+			}
+			else if (context.aborted.load()) {
+				//the watchdog has fired, the next phases run without the deadline until they find a path
+				context.aborted.store(false);
+				expired = true;
+				if (weight < expiredWeight) {
+					weight = 256 + 2 * (expiredWeight - 256); //the loop halves it back to expiredWeight
+					continue;
+				}
+			}
+			weight = 256 + 4 * (weight - 256);
+			continue;
+		}
+		if (!found || moves.size() < solution.moves.size()) {
+			solution.moves = moves;
+			found = true;
+			//g + w * h never goes over w * the optimal length on the optimal path, and the length has the parity of h
+			const int bound = (solution.moves.size() * 256 + weight - 1) / weight;
+			solution.lowerBound = std::max(solution.lowerBound, bound + ((bound - startHeuristic) & 1));
+			reportImprovement(id, begin, solution);
+		}
+		if (anytimeLimit == -1 || expired) {
+			break;
+		}
+	}
+
+	//without a time limit found is false only for the weights left to IDA*
+	if (!found || (anytimeLimit != -1 && !expired && !context.aborted.load())) {
+		const int limit = found ? solution.moves.size() : INT32_MAX;
+		int threshold = std::max(startHeuristic, solution.lowerBound);
+		while (threshold < limit) {
+			const int answer = runIteration(state, threshold, startHeuristic, solution);
+			if (answer == 0) {
+				solution.moves = state.moves;
+				solution.lowerBound = solution.moves.size();
+				reportImprovement(id, begin, solution);
+				break;
+			}
+			else if (context.aborted.load()) {
+				break;
+			}
+			threshold = answer;
+			if (found) {
+				solution.lowerBound = std::min(answer, limit);
+				reportImprovement(id, begin, solution);
+			}
+		}
+	}
+
+	if (timer.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(watchdogMutex);
+			finished = true;
+		}
+		watchdog.notify_one();
+		timer.join();
+	}
+	context.aborted.store(false);
+}
+
+template <class Board>
+const Solution IDA(const Puzzle& puzzle, SearchContext& context, const std::vector<int>& tiles, const long long id, const bool anytime = true,
+	const Solution* incumbent = nullptr) {
+	SearchState<Board> state{ &puzzle, &context, Board(), std::vector<SearchFrame>(), std::vector<Move>(), 0, 0, 0 };
+	state.board.load(puzzle, tiles);
+
+	Solution solution{ std::vector<Move>(), 0, 0, 0, std::vector<IterationStats>() };
+	const int startHeuristic = calculateHeuristic(puzzle, state.board);
+	if (anytimeWeight != 0 && anytime) {
+		anytimeSearch(state, startHeuristic, solution, id, incumbent);
+		return solution;
+	}
+
+	int threshold = startHeuristic;
+	while (true) {
+		int answer = runIteration(state, threshold, startHeuristic, solution);
+		if (answer == 0) {
+			break;
+		}
+		threshold = answer;
+	}
+
+	solution.moves = state.moves;
+	solution.lowerBound = solution.moves.size();
+	return solution;
+}
+
+//the board of the width with the heuristic of the puzzle
+template <template <int, Heuristic> class Board, int Width>
+const Solution IDA(const Puzzle& puzzle, SearchContext& context, const std::vector<int>& tiles, const long long id, const bool anytime,
+	const Solution* incumbent = nullptr) {
+	if (puzzle.usePatternDatabase) {
+		return IDA<Board<Width, withPatternDatabases>>(puzzle, context, tiles, id, anytime, incumbent);
+	}
+	else if (puzzle.useLinearConflict) {
+		return IDA<Board<Width, withLinearConflict>>(puzzle, context, tiles, id, anytime, incumbent);
+	}
+	return IDA<Board<Width, manhattanOnly>>(puzzle, context, tiles, id, anytime, incumbent);
+}
+
+//large boards - the rows and columns that do not hold the goal of the blank are solved one by one from the
+//outside in until a 3x3 is left, which is solved optimally by IDA*. A tile is routed along a shortest path of
+//free cells and the blank walks around it with breadth first search. The last two tiles of a line are parked
+//next to their targets and put in place by a breadth first search over the 3x3 window at the end of the line
+int reductionSize = 6; //boards of this size and larger are reduced
+int optimizeWindow = 0; //length of the windows of the local re-optimization, 0 - off
+const int windowNodeLimit = 1 << 18;
+
+struct ReductionLine {
+	std::vector<int> cells; //targets of the tiles in the order they are placed
+	int inward; //cell offset from the line into the part of the board that is left
+};
+
+//the lines in the order they are solved, corner is the top left cell of the 3x3 that is left
+const std::vector<ReductionLine> getReductionPlan(const int sizeOfBoard, const std::pair<int, int>& emptyTileTargetPos, int& corner) {
+	std::vector<ReductionLine> plan;
+	int top = 0, left = 0, height = sizeOfBoard, width = sizeOfBoard;
+	while (height > 3 || width > 3) {
+		ReductionLine line;
+		if (height >= width) {
+			//a row, the one without the goal of the blank
+			const bool first = emptyTileTargetPos.first != top;
+			const int row = first ? top : top + height - 1;
+			for (int col = left; col < left + width; col++) {
+				line.cells.push_back(row * sizeOfBoard + col);
+			}
+			line.inward = first ? sizeOfBoard : -sizeOfBoard;
+			top += first ? 1 : 0;
+			height--;
+		}
+		else {
+			const bool first = emptyTileTargetPos.second != left;
+			const int col = first ? left : left + width - 1;
+			for (int row = top; row < top + height; row++) {
+				line.cells.push_back(row * sizeOfBoard + col);
+			}
+			line.inward = first ? 1 : -1;
+			left += first ? 1 : 0;
+			width--;
+		}
+		plan.push_back(line);
+	}
+	corner = top * sizeOfBoard + left;
+	return plan;
+}
+
+struct Reducer {
+	const Puzzle* puzzle;
+	std::vector<int> tiles; //cell -> tile
+	std::vector<int> places; //tile -> cell
+	std::vector<int> targetTile; //cell -> the tile that belongs there
+	std::vector<char> locked;
+	std::vector<char> goal; //cells the breadth first search looks for
+	std::vector<int> parent; //move of the breadth first search into the cell, -1 if not reached
+	std::vector<int> queue;
+	std::vector<Move> moves;
+
+	void load(const Puzzle& puzzle, const std::vector<int>& board) {
+		this->puzzle = &puzzle;
+		tiles = board;
+		places.resize(puzzle.numberOfCells);
+		targetTile.assign(puzzle.numberOfCells, 0);
+		for (int cell = 0; cell < puzzle.numberOfCells; cell++) {
+			places[tiles[cell]] = cell;
+		}
+		for (int tile = 1; tile < puzzle.numberOfCells; tile++) {
+			targetTile[puzzle.targetPos[tile].first * puzzle.sizeOfBoard + puzzle.targetPos[tile].second] = tile;
+		}
+		locked.assign(puzzle.numberOfCells, 0);
+		goal.assign(puzzle.numberOfCells, 0);
+		parent.resize(puzzle.numberOfCells);
+		queue.resize(puzzle.numberOfCells);
+		moves.clear();
+	}
+
+	inline int getNeightbour(const int cell, const int move) const {
+		return puzzle->neightbourCells[cell * numberOfNeightbours + move];
+	}
+
+	void slide(const int move) {
+		const int blank = places[0];
+		const int cell = getNeightbour(blank, move);
+		const int tile = tiles[cell];
+		tiles[blank] = tile;
+		places[tile] = blank;
+		tiles[cell] = 0;
+		places[0] = cell;
+		moves.push_back(static_cast<Move>(move));
+	}
+
+	//breadth first search over the cells that are not locked or blocked, returns the first reached goal cell or -1
+	int findGoal(const int start, const int blocked) {
+		std::fill(parent.begin(), parent.end(), -1);
+		int head = 0, tail = 0;
+		queue[tail++] = start;
+		parent[start] = none;
+		while (head < tail) {
+			const int cell = queue[head++];
+			if (goal[cell]) {
+				return cell;
+			}
+			for (int i = 0; i < numberOfNeightbours; i++) {
+				const int next = getNeightbour(cell, i);
+				if (next != -1 && next != blocked && !locked[next] && parent[next] == -1) {
+					parent[next] = i;
+					queue[tail++] = next;
+				}
+			}
+		}
+		return -1;
+	}
+
+	//the cells from the start to the cell found by findGoal, without the start
+	void getPath(int cell, std::vector<int>& path) const {
+		path.clear();
+		while (parent[cell] != none) {
+			path.push_back(cell);
+			cell = getNeightbour(cell, getOppositeMove(static_cast<Move>(parent[cell])));
+		}
+		std::reverse(path.begin(), path.end());
+	}
+
+	//the blank goes to the nearest goal cell around the blocked one
+	bool walkBlank(const int blocked) {
+		const int found = findGoal(places[0], blocked);
+		if (found == -1) {
+			return false;
+		}
+		std::vector<int> path;
+		getPath(found, path);
+		for (const int cell : path) {
+			slide(parent[cell]);
+		}
+		return true;
+	}
+
+	bool walkBlankTo(const int target, const int blocked) {
+		goal[target] = 1;
+		const bool walked = walkBlank(blocked);
+		goal[target] = 0;
+		return walked;
+	}
+
+	inline int getMoveTo(const int from, const int to) const {
+		for (int i = 0; i < numberOfNeightbours; i++) {
+			if (getNeightbour(from, i) == to) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	//the tile follows a shortest path of free cells, the blank goes in front of it before every step
+	bool moveTile(const int tile, const int target) {
+		goal[target] = 1;
+		const int found = findGoal(places[tile], -1);
+		goal[target] = 0;
+		if (found == -1) {
+			return false;
+		}
+		std::vector<int> path;
+		getPath(found, path);
+		for (const int next : path) {
+			if (!walkBlankTo(next, places[tile])) {
+				return false;
+			}
+			slide(getMoveTo(next, places[tile]));
+		}
+		return true;
+	}
+
+	//breadth first search over the cells of the two tiles and the blank inside the window
+	bool solveWindow(const std::vector<int>& window, const int first, const int second, const int firstTarget, const int secondTarget) {
+		for (const int cell : window) {
+			goal[cell] = cell != places[first] && cell != places[second];
+		}
+		locked[places[first]] = 1;
+		const bool walked = walkBlank(places[second]);
+		locked[places[first]] = 0;
+		for (const int cell : window) {
+			goal[cell] = 0;
+		}
+		if (!walked) {
+			return false;
+		}
+
+		const int count = window.size();
+		auto indexOf = [&window](const int cell) {
+			return std::find(window.begin(), window.end(), cell) - window.begin();
+		};
+		auto encode = [count](const int a, const int b, const int blank) {
+			return (a * count + b) * count + blank;
+		};
+		std::vector<int> from(count * count * count, -1);
+		std::vector<int> order(1, encode(indexOf(places[first]), indexOf(places[second]), indexOf(places[0])));
+		from[order[0]] = order[0];
+		const int firstGoal = indexOf(firstTarget);
+		const int secondGoal = indexOf(secondTarget);
+		for (size_t i = 0; i < order.size(); i++) {
+			const int state = order[i];
+			const int a = state / (count * count);
+			const int b = state / count % count;
+			const int blank = state % count;
+			if (a == firstGoal && b == secondGoal) {
+				std::vector<int> cells;
+				for (int current = state; current != order[0]; current = from[current]) {
+					cells.push_back(window[current % count]);
+				}
+				for (int j = cells.size() - 1; j >= 0; j--) {
+					slide(getMoveTo(places[0], cells[j]));
+				}
+				return true;
+			}
+
+			for (int j = 0; j < numberOfNeightbours; j++) {
+				const int cell = getNeightbour(window[blank], j);
+				const int next = cell == -1 ? count : indexOf(cell);
+				if (next == count) {
+					continue;
+				}
+				const int nextState = encode(next == a ? blank : a, next == b ? blank : b, next);
+				if (from[nextState] == -1) {
+					from[nextState] = state;
+					order.push_back(nextState);
+				}
+			}
+		}
+		return false;
+	}
+
+	bool solveLine(const ReductionLine& line) {
+		const std::vector<int>& cells = line.cells;
+		const int length = cells.size();
+		for (int i = 0; i < length - 2; i++) {
+			if (!moveTile(targetTile[cells[i]], cells[i])) {
+				return false;
+			}
+			locked[cells[i]] = 1;
+		}
+
+		//the first of the last two goes to its target, the second right inside of the last cell
+		const int first = targetTile[cells[length - 2]];
+		const int second = targetTile[cells[length - 1]];
+		if (places[first] != cells[length - 2] || places[second] != cells[length - 1]) {
+			if (!moveTile(first, cells[length - 2])) {
+				return false;
+			}
+			locked[cells[length - 2]] = 1;
+			const bool parked = moveTile(second, cells[length - 1] + line.inward);
+			locked[cells[length - 2]] = 0;
+			if (!parked) {
+				return false;
+			}
+
+			std::vector<int> window;
+			for (int i = length - 3; i < length; i++) {
+				for (int depth = i == length - 3 ? 1 : 0; depth < 3; depth++) {
+					window.push_back(cells[i] + depth * line.inward);
+				}
+			}
+			if (!solveWindow(window, first, second, cells[length - 2], cells[length - 1])) {
+				return false;
+			}
+		}
+		locked[cells[length - 2]] = 1;
+		locked[cells[length - 1]] = 1;
+		return true;
+	}
+};
+
+//a move followed by its opposite does nothing
+void cancelBackMoves(std::vector<Move>& moves) {
+	int length = 0;
+	for (const Move move : moves) {
+		if (length > 0 && moves[length - 1] == getOppositeMove(move)) {
+			length--;
+		}
+		else {
+			moves[length++] = move;
+		}
+	}
+	moves.resize(length);
+}
+
+//local re-optimization - the moves of every window are replaced by the shortest path between its ends if that is
+//shorter. Only the tiles the window moves are not where they are at its end, so IDA* with their manhattan distance
+//to the end of the window is enough
+struct WindowSearch {
+	const Puzzle* puzzle;
+	std::vector<int> tiles;
+	std::vector<int> places;
+	std::vector<int> targets; //tile -> cell at the end of the window
+	std::vector<Move> path;
+	long long nodes;
+
+	inline int getDistance(const int tile, const int cell) const {
+		const int sizeOfBoard = puzzle->sizeOfBoard;
+		return abs(cell / sizeOfBoard - targets[tile] / sizeOfBoard) + abs(cell % sizeOfBoard - targets[tile] % sizeOfBoard);
+	}
+
+	bool search(const int limit, const int heuristic, const Move prevMove) {
+		if (heuristic == 0) {
+			return true;
+		}
+		else if (static_cast<int>(path.size()) + heuristic > limit || ++nodes > windowNodeLimit) {
+			return false;
+		}
+
+		const int blank = places[0];
+		for (int i = 0; i < numberOfNeightbours; i++) {
+			const int cell = puzzle->neightbourCells[blank * numberOfNeightbours + i];
+			if (cell == -1 || (prevMove != none && i == getOppositeMove(prevMove))) {
+				continue;
+			}
+			const int tile = tiles[cell];
+			const int delta = getDistance(tile, blank) - getDistance(tile, cell);
+			tiles[blank] = tile;
+			places[tile] = blank;
+			tiles[cell] = 0;
+			places[0] = cell;
+			path.push_back(static_cast<Move>(i));
+			if (search(limit, heuristic + delta, static_cast<Move>(i))) {
+				return true;
+			}
+			path.pop_back();
+			tiles[cell] = tile;
+			places[tile] = cell;
+			tiles[blank] = 0;
+			places[0] = blank;
+		}
+		return false;
+	}
+};
+
+void applyMove(const Puzzle& puzzle, std::vector<int>& tiles, std::vector<int>& places, const Move move) {
+	const int blank = places[0];
+	const int cell = puzzle.neightbourCells[blank * numberOfNeightbours + move];
+	const int tile = tiles[cell];
+	tiles[blank] = tile;
+	places[tile] = blank;
+	tiles[cell] = 0;
+	places[0] = cell;
+}
+
+void optimizeWindows(const Puzzle& puzzle, const std::vector<int>& start, std::vector<Move>& moves) {
+	std::vector<int> tiles = start;
+	std::vector<int> places(puzzle.numberOfCells);
+	for (int cell = 0; cell < puzzle.numberOfCells; cell++) {
+		places[tiles[cell]] = cell;
+	}
+
+	WindowSearch window{ &puzzle, tiles, places, places, std::vector<Move>(), 0 };
+	for (int i = 0; i + optimizeWindow <= static_cast<int>(moves.size()); ) {
+		window.tiles = tiles;
+		window.places = places;
+		for (int j = i; j < i + optimizeWindow; j++) {
+			applyMove(puzzle, window.tiles, window.places, moves[j]);
+		}
+		window.targets = window.places;
+		window.tiles = tiles;
+		window.places = places;
+
+		int heuristic = 0;
+		for (int tile = 1; tile < puzzle.numberOfCells; tile++) {
+			heuristic += window.getDistance(tile, places[tile]);
+		}
+		//every path between the same boards has the same parity
+		window.nodes = 0;
+		for (int limit = heuristic; limit < optimizeWindow; limit += 2) {
+			window.path.clear();
+			if (window.search(limit, heuristic, none)) {
+				moves.erase(moves.begin() + i, moves.begin() + i + optimizeWindow);
+				moves.insert(moves.begin() + i, window.path.begin(), window.path.end());
+				break;
+			}
+			else if (window.nodes > windowNodeLimit) {
+				break;
+			}
+		}
+
+		const int step = std::max(1, optimizeWindow / 2);
+		for (int j = i; j < i + step && j < static_cast<int>(moves.size()); j++) {
+			applyMove(puzzle, tiles, places, moves[j]);
+		}
+		i += step;
+	}
+}
+
+//false if a line could not be put in place, the board is then left to the direct search
+bool reduceBoard(const Puzzle& puzzle, SearchContext& context, const std::vector<int>& tiles, Solution& solution) {
+	Reducer reducer;
+	reducer.load(puzzle, tiles);
+	int corner;
+	const std::vector<ReductionLine>& plan = getReductionPlan(puzzle.sizeOfBoard, puzzle.emptyTileTargetPos, corner);
+	for (const ReductionLine& line : plan) {
+		if (!reducer.solveLine(line)) {
+			std::cerr << "Could not reduce the board, searching it directly." << std::endl;
+			return false;
+		}
+	}
+
+	//the tiles of the 3x3 that is left are renumbered by their targets inside it
+	const Puzzle& reduced = *puzzle.reducedPuzzle;
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	std::vector<int> localTile(reduced.numberOfCells, 0);
+	for (int tile = 1; tile < reduced.numberOfCells; tile++) {
+		localTile[reduced.targetPos[tile].first * reduced.sizeOfBoard + reduced.targetPos[tile].second] = tile;
+	}
+	std::vector<int> board(reduced.numberOfCells);
+	for (int cell = 0; cell < reduced.numberOfCells; cell++) {
+		const int tile = reducer.tiles[corner + cell / reduced.sizeOfBoard * sizeOfBoard + cell % reduced.sizeOfBoard];
+		const int target = tile == 0 ? 0 : puzzle.targetPos[tile].first * sizeOfBoard + puzzle.targetPos[tile].second - corner;
+		board[cell] = tile == 0 ? 0 : localTile[target / sizeOfBoard * reduced.sizeOfBoard + target % sizeOfBoard];
+	}
+
+	solution = IDA<PackedBoard, 3>(reduced, context, board, 0, false);
+	solution.moves.insert(solution.moves.begin(), reducer.moves.begin(), reducer.moves.end());
+	cancelBackMoves(solution.moves);
+	if (optimizeWindow > 0) {
+		optimizeWindows(puzzle, tiles, solution.moves);
+		cancelBackMoves(solution.moves);
+	}
+
+	GridBoard<> start;
+	start.load(puzzle, tiles);
+	solution.lowerBound = calculateHeuristic(puzzle, start);
+	return true;
+}
+
+//incumbent - a path the anytime search starts from, nullptr to search from scratch
+const Solution IDA(const Puzzle& puzzle, SearchContext& context, const std::vector<int>& tiles, const long long id = 0,
+	const Solution* incumbent = nullptr) {
+	if (puzzle.reducedPuzzle != nullptr) {
+		Solution solution;
+		if (reduceBoard(puzzle, context, tiles, solution)) {
+			return solution;
+		}
+	}
+	switch (puzzle.sizeOfBoard) {
+	case 3: return IDA<PackedBoard, 3>(puzzle, context, tiles, id, true, incumbent);
+	case 4: return IDA<PackedBoard, 4>(puzzle, context, tiles, id, true, incumbent);
+	case 5: return IDA<GridBoard, 5>(puzzle, context, tiles, id, true, incumbent);
+	default: return IDA<GridBoard, 0>(puzzle, context, tiles, id, true, incumbent);
+	}
+}
+
+//telemetry of every threshold iteration as one JSON object per puzzle, written to the stats file or stderr
+bool printStats = false;
+std::string statsFile;
+
+const std::string getStatsJson(const long long id, const Solution& solution, const long long time) {
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(4);
+	json << "{\"id\":" << id << ",\"length\":" << solution.moves.size() << ",\"lowerBound\":" << solution.lowerBound << ",\"time\":" << time <<
+		",\"expandedNodes\":" << solution.expandedNodes << ",\"generatedNodes\":" << solution.generatedNodes << ",\"iterations\":[";
+	for (size_t i = 0; i < solution.iterations.size(); i++) {
+		const IterationStats& stats = solution.iterations[i];
+		json << (i == 0 ? "" : ",") << "{\"threshold\":" << stats.threshold << ",\"expandedNodes\":" << stats.expandedNodes <<
+			",\"generatedNodes\":" << stats.generatedNodes << ",\"maxDepth\":" << stats.maxDepth <<
+			",\"branchingFactor\":" << stats.branchingFactor << ",\"time\":" << stats.time << "}";
+	}
+	json << "]}";
+	return json.str();
+}
+
+std::map<std::pair<int, int>, Puzzle> puzzles; //(size of the board, cell of the blank in the goal) -> tables
+
+//builds the tables the first time the goal is seen, only from the main thread before the solvers start
+const Puzzle& getPuzzle(const int sizeOfBoard, const std::pair<int, int>& emptyTileTargetPos) {
+	const std::pair<int, int> key(sizeOfBoard, emptyTileTargetPos.first * sizeOfBoard + emptyTileTargetPos.second);
+	std::map<std::pair<int, int>, Puzzle>::iterator found = puzzles.find(key);
+	if (found != puzzles.end()) {
+		return found->second;
+	}
+
+	Puzzle& puzzle = puzzles[key];
+	puzzle.sizeOfBoard = sizeOfBoard;
+	puzzle.numberOfCells = sizeOfBoard * sizeOfBoard;
+	puzzle.emptyTileTargetPos = emptyTileTargetPos;
+	setUpTargetPosTable(puzzle);
+	setUpMoveTables(puzzle);
+	puzzle.usePatternDatabase = usePatternDatabase && setUpPatternDatabases(puzzle);
+	//the conflicts are not additive with the pattern databases
+	puzzle.useLinearConflict = useLinearConflict && !puzzle.usePatternDatabase && sizeOfBoard <= maxLinearConflictSize;
+	if (puzzle.useLinearConflict) {
+		setUpLinearConflictTable(puzzle);
+	}
+
+	puzzle.perimeter.depth = 0;
+	puzzle.perimeter.mapping = nullptr;
+	if (perimeterDepth > 0) {
+		setUpPerimeter(puzzle);
+	}
+
+	puzzle.reducedPuzzle = nullptr;
+	if (sizeOfBoard >= reductionSize && sizeOfBoard > 3) {
+		int corner;
+		getReductionPlan(sizeOfBoard, emptyTileTargetPos, corner);
+		const std::pair<int, int> localTarget(emptyTileTargetPos.first - corner / sizeOfBoard, emptyTileTargetPos.second - corner % sizeOfBoard);
+		puzzle.reducedPuzzle = &getPuzzle(3, localTarget);
+	}
+	return puzzle;
+}
+
+void releasePuzzles() {
+	for (std::pair<const std::pair<int, int>, Puzzle>& entry : puzzles) {
+		releasePatternDatabases(entry.second);
+		releasePerimeter(entry.second);
+	}
+	puzzles.clear();
+}
+
+//number of tiles, index of the blank in the goal and the board row by row, false at the end of the input
+bool readPuzzle(std::istream& input, int& sizeOfBoard, std::pair<int, int>& emptyTileTargetPos, std::vector<int>& tiles) {
+	int numberOfTiles = -1;
+	int emptyTileNumber = -1;
+	if (!(input >> numberOfTiles >> emptyTileNumber) || numberOfTiles < 3) {
+		return false;
+	}
+	sizeOfBoard = sqrt(numberOfTiles + 1);
+	emptyTileTargetPos = getTargetPos(sizeOfBoard, emptyTileNumber - 1);
+
+	tiles.resize(sizeOfBoard * sizeOfBoard);
+	for (int& tile : tiles) {
+		if (!(input >> tile)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//persistent solution cache - an append-only file of records (size of the board, cell of the blank in the goal, number
+//of moves, lower bound, packed board, one byte per move), mapped at the start and indexed in memory. When the goal is
+//symmetric under the main diagonal a board and its transpose share one record under the smaller of the two packed
+//boards, the moves of the other one are transposed on the way in and out
+std::string cacheFile;
+
+struct CacheRecordHeader {
+	int sizeOfBoard;
+	int emptyTileCell;
+	int numberOfMoves;
+	int lowerBound;
+};
+
+struct CachedSolution {
+	const unsigned char* moves;
+	int numberOfMoves;
+	int lowerBound;
+};
+
+const char cacheFileMagic[4] = { 'S', 'O', 'L', '1' };
+
+struct SolutionCache {
+	int fd = -1;
+	void* mapping = nullptr;
+	size_t mappingSize = 0;
+	std::unordered_map<std::string, CachedSolution> index; //size and goal + packed board -> the best record
+	std::list<std::string> appended; //records written after the file was mapped
+	std::mutex mutex;
+};
+
+SolutionCache solutionCache;
+
+inline int getPackedBits(const int numberOfCells) {
+	int bits = 1;
+	while ((1 << bits) < numberOfCells) {
+		bits++;
+	}
+	return bits;
+}
+
+inline int getPackedSize(const int numberOfCells) {
+	return (numberOfCells * getPackedBits(numberOfCells) + 7) / 8;
+}
+
+//the tiles row by row with as few bits per tile as the board needs, 4 for 4x4
+const std::string packBoard(const int numberOfCells, const std::vector<int>& tiles) {
+	const int bits = getPackedBits(numberOfCells);
+	std::string packed(getPackedSize(numberOfCells), '\0');
+	for (int cell = 0; cell < numberOfCells; cell++) {
+		for (int bit = 0; bit < bits; bit++) {
+			if ((tiles[cell] >> bit) & 1) {
+				const int position = cell * bits + bit;
+				packed[position >> 3] |= 1 << (position & 7);
+			}
+		}
+	}
+	return packed;
+}
+
+inline bool isGoalSymmetric(const Puzzle& puzzle) {
+	return puzzle.emptyTileTargetPos.first == puzzle.emptyTileTargetPos.second;
+}
+
+//mirror image across the main diagonal, every tile takes the number of the tile whose target is its mirrored target
+const std::vector<int> transposeBoard(const Puzzle& puzzle, const std::vector<int>& tiles) {
+	const int sizeOfBoard = puzzle.sizeOfBoard;
+	std::vector<int> targetTile(puzzle.numberOfCells, 0);
+	for (int tile = 1; tile < puzzle.numberOfCells; tile++) {
+		targetTile[puzzle.targetPos[tile].first * sizeOfBoard + puzzle.targetPos[tile].second] = tile;
+	}
+	std::vector<int> transposed(puzzle.numberOfCells);
+	for (int cell = 0; cell < puzzle.numberOfCells; cell++) {
+		const int tile = tiles[cell];
+		const std::pair<int, int>& target = puzzle.targetPos[tile];
+		transposed[cell % sizeOfBoard * sizeOfBoard + cell / sizeOfBoard] = tile == 0 ? 0 : targetTile[target.second * sizeOfBoard + target.first];
+	}
+	return transposed;
+}
+
+//the rows and the columns swap places
+inline Move getTransposedMove(const Move move) {
+	switch (move) {
+	case up: return left;
+	case down: return right;
+	case right: return down;
+	case left: return up;
+	default: return none;
+	}
+}
+
+//the key of the board and whether the record is the one of its transpose
+const std::string getCacheKey(const Puzzle& puzzle, const std::vector<int>& tiles, bool& transposed) {
+	const int emptyTileCell = puzzle.emptyTileTargetPos.first * puzzle.sizeOfBoard + puzzle.emptyTileTargetPos.second;
+	std::string key(reinterpret_cast<const char*>(&puzzle.sizeOfBoard), sizeof(int));
+	key.append(reinterpret_cast<const char*>(&emptyTileCell), sizeof(int));
+	const std::string& packed = packBoard(puzzle.numberOfCells, tiles);
+	transposed = false;
+	if (isGoalSymmetric(puzzle)) {
+		const std::string& mirror = packBoard(puzzle.numberOfCells, transposeBoard(puzzle, tiles));
+		if (mirror < packed) {
+			transposed = true;
+			return key + mirror;
+		}
+	}
+	return key + packed;
+}
+
+//a proven optimal record beats any other, otherwise the shorter one wins, and of two equally long the one with the
+//higher lower bound
+inline bool isBetterRecord(const CachedSolution& record, const CachedSolution& current) {
+	const bool optimal = record.lowerBound == record.numberOfMoves;
+	const bool currentOptimal = current.lowerBound == current.numberOfMoves;
+	if (optimal != currentOptimal) {
+		return optimal;
+	}
+	return record.numberOfMoves != current.numberOfMoves ? record.numberOfMoves < current.numberOfMoves : record.lowerBound > current.lowerBound;
+}
+
+void indexRecord(const std::string& key, const CachedSolution& record) {
+	std::unordered_map<std::string, CachedSolution>::iterator found = solutionCache.index.find(key);
+	if (found == solutionCache.index.end()) {
+		solutionCache.index.emplace(key, record);
+	}
+	else if (isBetterRecord(record, found->second)) {
+		found->second = record;
+	}
+}
+
+//size of the record at the start of data, 0 if it is cut off or broken
+size_t readRecord(const char* data, const size_t size, std::string& key, CachedSolution& record) {
+	CacheRecordHeader header;
+	if (size < sizeof(header)) {
+		return 0;
+	}
+	std::memcpy(&header, data, sizeof(header));
+	if (header.sizeOfBoard < 2 || header.sizeOfBoard > 256 || header.emptyTileCell < 0 ||
+		header.emptyTileCell >= header.sizeOfBoard * header.sizeOfBoard || header.numberOfMoves < 0) {
+		return 0;
+	}
+	const size_t packedSize = getPackedSize(header.sizeOfBoard * header.sizeOfBoard);
+	const size_t recordSize = sizeof(header) + packedSize + header.numberOfMoves;
+	if (size < recordSize) {
+		return 0;
+	}
+
+	key.assign(data, 2 * sizeof(int));
+	key.append(data + sizeof(header), packedSize);
+	record = CachedSolution{ reinterpret_cast<const unsigned char*>(data + sizeof(header) + packedSize), header.numberOfMoves, header.lowerBound };
+	return recordSize;
+}
+
+//maps the records that are already in the file, a record cut off at the end is dropped
+bool openSolutionCache(const std::string& fileName) {
+	const int fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+	struct stat info;
+	if (fd == -1 || fstat(fd, &info) == -1) {
+		std::cerr << "Could not open the solution cache " << fileName << std::endl;
+		if (fd != -1) {
+			close(fd);
+		}
+		return false;
+	}
+
+	size_t end = sizeof(cacheFileMagic);
+	if (info.st_size == 0) {
+		if (write(fd, cacheFileMagic, sizeof(cacheFileMagic)) != sizeof(cacheFileMagic)) {
+			close(fd);
+			return false;
+		}
+	}
+	else {
+		void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (mapping == MAP_FAILED || static_cast<size_t>(info.st_size) < sizeof(cacheFileMagic) || std::memcmp(mapping, cacheFileMagic, sizeof(cacheFileMagic)) != 0) {
+			std::cerr << "The solution cache " << fileName << " is not valid." << std::endl;
+			if (mapping != MAP_FAILED) {
+				munmap(mapping, info.st_size);
+			}
+			close(fd);
+			return false;
+		}
+		solutionCache.mapping = mapping;
+		solutionCache.mappingSize = info.st_size;
+
+		const char* data = static_cast<const char*>(mapping);
+		std::string key;
+		CachedSolution record;
+		for (size_t size; (size = readRecord(data + end, info.st_size - end, key, record)) != 0; end += size) {
+			indexRecord(key, record);
+		}
+		if (end < static_cast<size_t>(info.st_size) && ftruncate(fd, end) == -1) {
+			close(fd);
+			return false;
+		}
+	}
+	solutionCache.fd = fd;
+	return true;
+}
+
+void closeSolutionCache() {
+	if (solutionCache.mapping != nullptr) {
+		munmap(solutionCache.mapping, solutionCache.mappingSize);
+		solutionCache.mapping = nullptr;
+	}
+	if (solutionCache.fd != -1) {
+		close(solutionCache.fd);
+		solutionCache.fd = -1;
+	}
+	solutionCache.index.clear();
+	solutionCache.appended.clear();
+}
+
+bool isSolution(const Puzzle& puzzle, std::vector<int> tiles, const std::vector<Move>& moves) {
+	int blank = std::find(tiles.begin(), tiles.end(), 0) - tiles.begin();
+	for (const Move move : moves) {
+		const int cell = puzzle.neightbourCells[blank * numberOfNeightbours + move];
+		if (cell == -1) {
+			return false;
+		}
+		std::swap(tiles[blank], tiles[cell]);
+		blank = cell;
+	}
+	for (int cell = 0; cell < puzzle.numberOfCells; cell++) {
+		const int tile = tiles[cell];
+		if (tile != 0 && puzzle.targetPos[tile].first * puzzle.sizeOfBoard + puzzle.targetPos[tile].second != cell) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//the best record of the board, false if there is none
+bool findCachedSolution(const Puzzle& puzzle, const std::vector<int>& tiles, Solution& solution) {
+	bool transposed;
+	const std::string& key = getCacheKey(puzzle, tiles, transposed);
+	std::lock_guard<std::mutex> lock(solutionCache.mutex);
+	std::unordered_map<std::string, CachedSolution>::const_iterator found = solutionCache.index.find(key);
+	if (found == solutionCache.index.end()) {
+		return false;
+	}
+
+	const CachedSolution& record = found->second;
+	solution = Solution{ std::vector<Move>(record.numberOfMoves), record.lowerBound, 0, 0, std::vector<IterationStats>() };
+	for (int i = 0; i < record.numberOfMoves; i++) {
+		const Move move = static_cast<Move>(record.moves[i]);
+		solution.moves[i] = transposed ? getTransposedMove(move) : move;
+	}
+	return true;
+}
+
+void storeSolution(const Puzzle& puzzle, const std::vector<int>& tiles, const Solution& solution) {
+	if (!isSolution(puzzle, tiles, solution.moves)) {
+		return;
+	}
+	bool transposed;
+	const std::string& key = getCacheKey(puzzle, tiles, transposed);
+	const CacheRecordHeader header{ puzzle.sizeOfBoard, puzzle.emptyTileTargetPos.first * puzzle.sizeOfBoard + puzzle.emptyTileTargetPos.second,
+		static_cast<int>(solution.moves.size()), solution.lowerBound };
+	std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+	data.append(key, 2 * sizeof(int), std::string::npos);
+	for (const Move move : solution.moves) {
+		data += static_cast<char>(transposed ? getTransposedMove(move) : move);
+	}
+
+	std::lock_guard<std::mutex> lock(solutionCache.mutex);
+	std::unordered_map<std::string, CachedSolution>::const_iterator found = solutionCache.index.find(key);
+	const CachedSolution record{ nullptr, header.numberOfMoves, header.lowerBound };
+	if (found != solutionCache.index.end() && !isBetterRecord(record, found->second)) {
+		return;
+	}
+	if (write(solutionCache.fd, data.data(), data.size()) != static_cast<ssize_t>(data.size())) {
+		std::cerr << "Could not write to the solution cache." << std::endl;
+		return;
+	}
+	solutionCache.appended.push_back(data);
+	const std::string& stored = solutionCache.appended.back();
+	indexRecord(key, CachedSolution{ reinterpret_cast<const unsigned char*>(stored.data()) + stored.size() - header.numberOfMoves,
+		header.numberOfMoves, header.lowerBound });
+}
+
+//IDA behind the solution cache - a record is returned when it keeps the bound of the search: optimal, at most w times
+//the lower bound for the anytime search, anything for the reduction of large boards. With a time limit a record that
+//is not optimal is where the anytime search starts from
+const Solution solve(const Puzzle& puzzle, SearchContext& context, const std::vector<int>& tiles, const long long id = 0) {
+	if (solutionCache.fd == -1) {
+		return IDA(puzzle, context, tiles, id);
+	}
+	Solution cached;
+	bool found = findCachedSolution(puzzle, tiles, cached);
+	if (found) {
+		const long long length = cached.moves.size();
+		if (puzzle.reducedPuzzle != nullptr || length == cached.lowerBound ||
+			(anytimeWeight != 0 && anytimeLimit == -1 && length * 256 <= static_cast<long long>(anytimeWeight) * cached.lowerBound)) {
+			return cached;
+		}
+	}
+	const Solution& solution = IDA(puzzle, context, tiles, id, found && anytimeWeight != 0 && anytimeLimit != -1 ? &cached : nullptr);
+	storeSolution(puzzle, tiles, solution);
+	return solution;
+}
+
+struct BatchInstance {
+	long long id;
+	const Puzzle* puzzle;
+	std::vector<int> tiles;
+	bool solvable;
+	int heuristic;
+};
+
+//reads puzzles until the end of the input, the largest starting heuristic is solved first and every result is
+//printed as soon as it is ready:
+//<puzzle id> <length> <time in microseconds> <expanded nodes> <iterations> <moves>
+//<puzzle id> unsolvable
+//with --stats the telemetry of every solved puzzle goes to the stats stream as one JSON line
+void batch(std::istream& input, std::ostream& stats) {
+	std::vector<BatchInstance> instances;
+	int sizeOfBoard;
+	std::pair<int, int> emptyTileTargetPos;
+	std::vector<int> tiles;
+	while (readPuzzle(input, sizeOfBoard, emptyTileTargetPos, tiles)) {
+		BatchInstance instance{ static_cast<long long>(instances.size()), nullptr, tiles, isSolvable(sizeOfBoard, emptyTileTargetPos, tiles), 0 };
+		if (instance.solvable) {
+			instance.puzzle = &getPuzzle(sizeOfBoard, emptyTileTargetPos);
+			GridBoard<> board;
+			board.load(*instance.puzzle, tiles);
+			instance.heuristic = calculateHeuristic(*instance.puzzle, board);
+		}
+		instances.push_back(instance);
+	}
+
+	std::vector<int> order(instances.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&instances](const int a, const int b) {
+		return instances[a].heuristic > instances[b].heuristic;
+	});
+
+	std::atomic<int> next(0);
+	std::mutex outputMutex;
+	auto work = [&]() {
+		SearchContext context;
+		std::string line;
+		for (int i = next++; i < static_cast<int>(order.size()); i = next++) {
+			const BatchInstance& instance = instances[order[i]];
+			line = std::to_string(instance.id);
+			std::string json;
+			if (!instance.solvable) {
+				line += " unsolvable";
+			}
+			else {
+				std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+				const Solution& solution = solve(*instance.puzzle, context, instance.tiles, instance.id);
+				std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+				const long long time = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+				line += " " + std::to_string(solution.moves.size()) + " " + std::to_string(time) + " " +
+					std::to_string(solution.expandedNodes) + " " + std::to_string(solution.iterations.size());
+				if (printStats) {
+					json = getStatsJson(instance.id, solution, time) + "\n";
+				}
+				for (const Move move : solution.moves) {
+					line += ' ';
+					line += getMoveName(move);
+				}
+			}
+			line += '\n';
+
+			std::lock_guard<std::mutex> lock(outputMutex);
+			std::cout << line << std::flush;
+			stats << json << std::flush;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < numberOfThreads; i++) {
+		threads.emplace_back(work);
+	}
+	work();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+int main(int argc, char** argv) {
+	bool batchMode = false;
+	std::string batchFile;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--pdb") {
+			usePatternDatabase = true;
+		}
+		else if (arg.rfind("--pdb=", 0) == 0) {
+			//sizes of the groups, e.g. --pdb=6-6-3
+			usePatternDatabase = true;
+			for (size_t start = 6; start < arg.size(); ) {
+				size_t end = arg.find('-', start);
+				end = end == std::string::npos ? arg.size() : end;
+				patternPartition.push_back(std::stoi(arg.substr(start, end - start)));
+				start = end + 1;
+			}
+		}
+		else if (arg == "--linear-conflict") {
+			useLinearConflict = true;
+		}
+		else if (arg.rfind("--pdb-dir=", 0) == 0) {
+			patternDirectory = arg.substr(10);
+		}
+		else if (arg == "--parallel") {
+			useParallelSearch = true;
+		}
+		else if (arg.rfind("--parallel-depth=", 0) == 0) {
+			useParallelSearch = true;
+			parallelDepth = std::max(1, std::stoi(arg.substr(17)));
+		}
+		else if (arg == "--fsm") {
+			duplicateDepth = 12;
+		}
+		else if (arg.rfind("--fsm=", 0) == 0) {
+			duplicateDepth = std::max(2, std::min(maxDuplicateDepth, std::stoi(arg.substr(6))));
+		}
+		else if (arg == "--tt") {
+			useTranspositionTable = true;
+		}
+		else if (arg.rfind("--tt=", 0) == 0) {
+			//log2 of the number of entries
+			useTranspositionTable = true;
+			transpositionBits = std::min(28, std::max(10, std::stoi(arg.substr(5))));
+		}
+		else if (arg.rfind("--threads=", 0) == 0) {
+			numberOfThreads = std::max(1, std::stoi(arg.substr(10)));
+		}
+		else if (arg.rfind("--weight=", 0) == 0) {
+			//suboptimality factor of the anytime search, e.g. --weight=1.5
+			anytimeWeight = std::max(256, static_cast<int>(std::stod(arg.substr(9)) * 256 + 0.5));
+		}
+		else if (arg.rfind("--time-limit=", 0) == 0) {
+			//milliseconds
+			anytimeLimit = std::max(0, std::stoi(arg.substr(13)));
+		}
+		else if (arg == "--perimeter") {
+			perimeterDepth = 12;
+		}
+		else if (arg.rfind("--perimeter=", 0) == 0) {
+			perimeterDepth = std::max(0, std::min(maxPerimeterDepth, std::stoi(arg.substr(12))));
+		}
+		else if (arg == "--perimeter-map") {
+			mapPerimeter = true;
+		}
+		else if (arg.rfind("--reduce=", 0) == 0) {
+			//boards of this size and larger are solved line by line down to a 3x3
+			reductionSize = std::stoi(arg.substr(9));
+		}
+		else if (arg == "--optimize") {
+			optimizeWindow = 16;
+		}
+		else if (arg.rfind("--optimize=", 0) == 0) {
+			optimizeWindow = std::max(0, std::stoi(arg.substr(11)));
+		}
+		else if (arg == "--cache") {
+			cacheFile = "solutions.bin";
+		}
+		else if (arg.rfind("--cache=", 0) == 0) {
+			cacheFile = arg.substr(8);
+		}
+		else if (arg == "--batch") {
+			batchMode = true;
+		}
+		else if (arg.rfind("--batch=", 0) == 0) {
+			batchMode = true;
+			batchFile = arg.substr(8);
+		}
+		else if (arg == "--stats") {
+			printStats = true;
+		}
+		else if (arg.rfind("--stats=", 0) == 0) {
+			printStats = true;
+			statsFile = arg.substr(8);
+		}
+	}
+
+	if (anytimeLimit != -1 && anytimeWeight == 0) {
+		anytimeWeight = defaultAnytimeWeight;
+	}
+	if (anytimeWeight != 0) {
+		//the deadline aborts the search with the flag the parallel search uses for a found solution
+		useParallelSearch = false;
+	}
+
+	if (!cacheFile.empty() && !openSolutionCache(cacheFile)) {
+		return 1;
+	}
+
+	std::ofstream statsOutput;
+	if (!statsFile.empty()) {
+		statsOutput.open(statsFile, std::ios::trunc);
+	}
+	std::ostream& stats = statsFile.empty() ? std::cerr : statsOutput;
+
+	if (batchMode) {
+		//the puzzles are solved in parallel, each one by a single thread
+		useParallelSearch = false;
+		setUpDuplicateAutomaton();
+		std::ios::sync_with_stdio(false);
+		std::ifstream file;
+		if (!batchFile.empty()) {
+			file.open(batchFile);
+			if (!file) {
+				std::cerr << "Could not open " << batchFile << std::endl;
+				return 1;
+			}
+		}
+		batch(batchFile.empty() ? std::cin : file, stats);
+		releasePuzzles();
+		closeSolutionCache();
+		return 0;
+	}
+
+	int sizeOfBoard;
+	std::pair<int, int> emptyTileTargetPos;
+	std::vector<int> board;
+	if (!readPuzzle(std::cin, sizeOfBoard, emptyTileTargetPos, board)) {
+		return 0;
+	}
+
+	if (!isSolvable(sizeOfBoard, emptyTileTargetPos, board)) {
+		std::cout << "The puzzle is unsolvable." << std::endl;
+		return 0;
+	}
+	setUpDuplicateAutomaton();
+	const Puzzle& puzzle = getPuzzle(sizeOfBoard, emptyTileTargetPos);
+	SearchContext context;
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	const Solution& solution = solve(puzzle, context, board);
+	std::cout << solution.moves.size() << std::endl;
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	std::cout << "Time consumed :" << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+
+	for (size_t i = 0; i < solution.moves.size(); i++) {
+		std::cout << std::endl << getMoveName(solution.moves[i]);
+	}
+
+	if (printStats) {
+		stats << getStatsJson(0, solution, std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) << std::endl;
+	}
+
+	releasePuzzles();
+	closeSolutionCache();
 	return 0;
 }
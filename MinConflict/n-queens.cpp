@@ -1,36 +1,78 @@
 #include <iostream>
 #include <vector>
+#include <deque>
 #include <algorithm>
-#include <time.h>  
+#include <time.h>
 #include <random>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
 
-int sizeOfBoardd;
-int* queens;
-int* rows;
-int* diagonal1; //array of all diagonals x1 - y1 = x2 - y2 
-int* diagonal2; //array of all diagonals x1 + y1 = x2 + y2
+const int k = 1000;
 
-int* container;
+//reentrant solver - every instance owns its buffers and random generator,
+//buffers only grow, so a solver can be reused for many boards without reallocating
+class MinConflictSolver {
+public:
+	explicit MinConflictSolver(const unsigned long long seed) : sizeOfBoardd(0), rng(seed) {}
+
+	void reset(const int size) {
+		sizeOfBoardd = size;
+		if (queens.size() < static_cast<size_t>(size)) {
+			queens.resize(size);
+			rows.resize(size);
+			container.resize(size);
+			diagonal1.resize(2 * size - 1);
+			diagonal2.resize(2 * size - 1);
+		}
+	}
 
-const int k = 1000;
-std::mt19937 rng(std::chrono::steady_clock::now().time_since_epoch().count());
+	int getSize() const {
+		return sizeOfBoardd;
+	}
 
-inline int getDiag1Index(const int x, const int y) {
-	return x - y + sizeOfBoardd - 1;
-}
+	const int* getQueens() const {
+		return queens.data();
+	}
 
-inline int getDiag2Index(const int x, const int y) {
-	return x + y;
-}
+	void initializeBoard();
+	int minimumConflict();
+	void printBoard() const;
 
-inline int getConflicts(const int x, const int y) {
-	return diagonal1[getDiag1Index(x, y)] +
-		diagonal2[getDiag2Index(x, y)] +
-		rows[y];
-}
+private:
+	inline int getDiag1Index(const int x, const int y) const {
+		return x - y + sizeOfBoardd - 1;
+	}
+
+	inline int getDiag2Index(const int x, const int y) const {
+		return x + y;
+	}
+
+	inline int getConflicts(const int x, const int y) const {
+		return diagonal1[getDiag1Index(x, y)] +
+			diagonal2[getDiag2Index(x, y)] +
+			rows[y];
+	}
+
+	inline void updateConflictStatistics(const int queenIdx, const int newRow);
+	inline const std::pair<int, int> getMaxConflictQueen();
+	inline int getLeastConflictRow(const int queen);
+
+	int sizeOfBoardd;
+	std::vector<int> queens;
+	std::vector<int> rows;
+	std::vector<int> diagonal1; //array of all diagonals x1 - y1 = x2 - y2
+	std::vector<int> diagonal2; //array of all diagonals x1 + y1 = x2 + y2
+	std::vector<int> container;
+	std::mt19937 rng;
+};
 
-inline void updateConflictStatistics(const int queenIdx, const int newRow) {
+inline void MinConflictSolver::updateConflictStatistics(const int queenIdx, const int newRow) {
 	//if the queen wasnt place on the board before
 	if (queens[queenIdx] != -1) {
 		rows[queens[queenIdx]]--;
@@ -45,7 +87,7 @@ inline void updateConflictStatistics(const int queenIdx, const int newRow) {
 	diagonal2[getDiag2Index(queenIdx, newRow)]++;
 }
 
-void initializeBoard() {
+void MinConflictSolver::initializeBoard() {
 
 	//initialize board statistics
 	for (int i = 0; i < 2 * sizeOfBoardd - 1; i++) {
@@ -57,7 +99,7 @@ void initializeBoard() {
 		rows[i] = 0;
 		queens[i] = -1;
 	}
-	
+
 	//populate board with the queens
 	updateConflictStatistics(0, rng() % sizeOfBoardd);
 
@@ -87,7 +129,7 @@ void initializeBoard() {
 	}
 }
 
-inline const std::pair<int,int> getMaxConflictQueen() {
+inline const std::pair<int,int> MinConflictSolver::getMaxConflictQueen() {
 	int frontConflicts = 0;
 	int bestCount = 0;
 	for (int i = 0; i < sizeOfBoardd; i++) {
@@ -110,9 +152,9 @@ inline const std::pair<int,int> getMaxConflictQueen() {
 	return std::pair<int,int>(container[winner],frontConflicts);
 }
 
-inline int getLeastConflictRow(const int queen) {
+inline int MinConflictSolver::getLeastConflictRow(const int queen) {
 	const int currentRow = queens[queen];
-	
+
 	int bestCount = 0;
 	int frontCollisions = INT32_MAX;
 	for (int i = 0; i < sizeOfBoardd; i++) {
@@ -138,24 +180,26 @@ inline int getLeastConflictRow(const int queen) {
 	return container[winner];
 }
 
-void minimumConflict() {
-	initializeBoard();
+//returns the number of restarts that were needed
+int MinConflictSolver::minimumConflict() {
+	int restarts = 0;
+	while (true) {
+		initializeBoard();
 
-	int maxConflictQueen = -1;
-	for (int i = 0; i <= k * sizeOfBoardd; i++) {
-		const std::pair<int,int>& maxConflictQueen = getMaxConflictQueen();
-		if (maxConflictQueen.second == 0) {
-			return;
-		}
-		const int leastConflictRow = getLeastConflictRow(maxConflictQueen.first);
+		for (int i = 0; i <= k * sizeOfBoardd; i++) {
+			const std::pair<int,int>& maxConflictQueen = getMaxConflictQueen();
+			if (maxConflictQueen.second == 0) {
+				return restarts;
+			}
+			const int leastConflictRow = getLeastConflictRow(maxConflictQueen.first);
 
-		updateConflictStatistics(maxConflictQueen.first, leastConflictRow);
+			updateConflictStatistics(maxConflictQueen.first, leastConflictRow);
+		}
+		restarts++;
 	}
-	std::cout << "restart" << std::endl;
-	minimumConflict();
 }
 
-void printBoard() {
+void MinConflictSolver::printBoard() const {
 	for (int i = 0; i < sizeOfBoardd; i++) {
 		for (int j = 0; j < sizeOfBoardd; j++) {
 			if (queens[j] != i) std::cout << "- ";
@@ -165,24 +209,195 @@ void printBoard() {
 	}
 }
 
-int main() {
+struct Request {
+	long long id;
+	int size;
+};
+
+//thread pool with a deque per worker - the owner and the idle workers that steal from it all take the oldest
+//request from the front, so the requests are answered roughly in the order they were read
+class WorkStealingPool {
+public:
+	explicit WorkStealingPool(const int numberOfWorkers) : queues(numberOfWorkers), pending(0), closed(false), nextQueue(0) {
+		const unsigned long long seed = std::chrono::steady_clock::now().time_since_epoch().count();
+		for (int i = 0; i < numberOfWorkers; i++) {
+			solvers.emplace_back(seed + i);
+		}
+		for (int i = 0; i < numberOfWorkers; i++) {
+			workers.emplace_back(&WorkStealingPool::run, this, i);
+		}
+	}
+
+	~WorkStealingPool() {
+		close();
+	}
+
+	void submit(const Request& request) {
+		WorkerQueue& queue = queues[nextQueue++ % queues.size()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.requests.push_back(request);
+		}
+		{
+			std::lock_guard<std::mutex> lock(idleMutex);
+			pending++;
+		}
+		idle.notify_one();
+	}
+
+	//waits for all submitted requests and stops the workers
+	void close() {
+		{
+			std::lock_guard<std::mutex> lock(idleMutex);
+			if (closed) {
+				return;
+			}
+			closed = true;
+		}
+		idle.notify_all();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+private:
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<Request> requests;
+	};
+
+	bool tryPop(const int workerIdx, Request& request) {
+		WorkerQueue& own = queues[workerIdx];
+		{
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.requests.empty()) {
+				request = own.requests.front();
+				own.requests.pop_front();
+				return true;
+			}
+		}
+
+		for (size_t i = 1; i < queues.size(); i++) {
+			WorkerQueue& victim = queues[(workerIdx + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.requests.empty()) {
+				request = victim.requests.front();
+				victim.requests.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void run(const int workerIdx) {
+		MinConflictSolver& solver = solvers[workerIdx];
+		std::string line;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(idleMutex);
+				idle.wait(lock, [this]() { return pending > 0 || closed; });
+				if (pending == 0) {
+					return;
+				}
+				pending--;
+			}
+
+			//pending counts the requests in the deques, so one is guaranteed to be found
+			Request request;
+			while (!tryPop(workerIdx, request));
+
+			line.clear();
+			if (request.size < 1 || request.size == 2 || request.size == 3) {
+				//no arrangement exists, the line keeps the id so that the results still match the input
+				line += std::to_string(request.id) + " unsolvable\n";
+			}
+			else {
+				std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+				solver.reset(request.size);
+				const int restarts = solver.minimumConflict();
+				std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+				line += std::to_string(request.id) + " " + std::to_string(request.size) + " " +
+					std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()) + " " +
+					std::to_string(restarts);
+				const int* queens = solver.getQueens();
+				for (int i = 0; i < request.size; i++) {
+					line += ' ';
+					line += std::to_string(queens[i]);
+				}
+				line += '\n';
+			}
+
+			std::lock_guard<std::mutex> lock(outputMutex);
+			std::cout << line << std::flush;
+		}
+	}
+
+	std::vector<WorkerQueue> queues;
+	std::vector<MinConflictSolver> solvers;
+	std::vector<std::thread> workers;
+	std::mutex idleMutex;
+	std::condition_variable idle;
+	long long pending;
+	bool closed;
+	std::atomic<unsigned long long> nextQueue;
+	std::mutex outputMutex;
+};
+
+//reads board sizes until the end of the input, every result is printed as soon as it is ready:
+//<request id> <size> <time in microseconds> <restarts> <row of the queen in each column>, or <request id> unsolvable
+void batch(const int numberOfWorkers) {
+	WorkStealingPool pool(numberOfWorkers);
+	long long id = 0;
+	int size;
+	while (std::cin >> size) {
+		pool.submit(Request{ id++, size });
+	}
+	pool.close();
+}
+
+int main(int argc, char** argv) {
+	int numberOfWorkers = -1;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--batch") {
+			numberOfWorkers = std::max(1u, std::thread::hardware_concurrency());
+		}
+		else if (arg.rfind("--threads=", 0) == 0) {
+			const char* value = arg.c_str() + 10;
+			char* end = nullptr;
+			const long threads = std::strtol(value, &end, 10);
+			if (end == value || *end != '\0' || threads < 1 || threads > 1024) {
+				std::cerr << "Invalid number of threads: " << value << std::endl;
+				return 1;
+			}
+			numberOfWorkers = static_cast<int>(threads);
+		}
+	}
+
+	if (numberOfWorkers != -1) {
+		std::ios::sync_with_stdio(false);
+		//reading must not flush std::cout behind the back of the workers
+		std::cin.tie(nullptr);
+		batch(numberOfWorkers);
+		return 0;
+	}
+
+	int sizeOfBoardd;
 	std::cin >> sizeOfBoardd;
 
-	queens = new int[sizeOfBoardd];
-	rows = new int[sizeOfBoardd];
-	container = new int[sizeOfBoardd];
-	diagonal1 = new int[2*sizeOfBoardd-1];
-	diagonal2 = new int[2*sizeOfBoardd-1];
+	MinConflictSolver solver(std::chrono::steady_clock::now().time_since_epoch().count());
+	solver.reset(sizeOfBoardd);
 
 	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-	initializeBoard();
-	//minimumConflict();
+	solver.initializeBoard();
+	//solver.minimumConflict();
 	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
 	std::cout << "Time consumed :" << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
 
 	if (sizeOfBoardd <= 50) {
-		printBoard();
+		solver.printBoard();
 	}
 
 	return 0;
-}
\ No newline at end of file
+}